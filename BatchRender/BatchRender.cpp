@@ -0,0 +1,607 @@
+/*
+  ==============================================================================
+
+    BatchRender.cpp
+
+    Headless offline renderer: runs SimpleEQ1AudioProcessor over a list of
+    audio files (anything juce::AudioFormatManager reads: WAV, AIFF, FLAC,
+    Ogg...) with the settings from a preset, and writes the results in the
+    input's format and bit depth. Long files are split into segments, and
+    every segment of every file is rendered in parallel on a thread pool.
+    Reports the throughput as a multiple of realtime.
+
+    A segment starts rendering "overlap" seconds before its first output
+    sample, so the filters, the dynamic EQ's detector and the Auto Gain
+    meters have settled into the same state they'd be in if the file were
+    rendered in one go; by default the overlap is the processor's tail plus
+    its settling time plus half a second. The processor's latency is
+    compensated, so the output lines up with the input. --verify checks
+    that: every segmented file is rendered once more in one piece, and the
+    two renders are compared sample by sample.
+
+    With --pack, segments with the same rate and channel count are rendered
+    side by side through one processor with a wider bus, so they share the
+    SIMD lanes a single segment would leave idle (two stereo segments fill
+    a 4-lane register). That only works when the settings don't mix
+    channels, see SimpleEQ1AudioProcessor::processesChannelsIndependently();
+    otherwise every segment gets a processor of its own, as without it.
+    This is offline only: the plug-in doesn't pack separate instances
+    together, see SimpleEQ1AudioProcessor::getNumLanes().
+
+    Options:
+        --preset <file>        settings: a plugin state (as saved by the plugin)
+                               or an XML <Preset> with <Parameter id="" value=""/>
+                               children, values in parameter units
+        --output-dir <dir>     where the rendered files go (default: ./rendered)
+        --threads <n>          worker threads (default: one per core)
+        --block <n>            samples per processBlock call (default 8192)
+        --segment <s>          segment length in seconds (default 60)
+        --overlap <s>          pre-roll per segment in seconds
+                               (default: tail + settling time + 0.5)
+        --pack                 render segments side by side in the SIMD lanes
+        --verify <dB>          fail a file whose segmented render differs from
+                               a whole-file render by more than this (dBFS)
+
+    Everything else on the command line is an input file. Each output file
+    is named after its input; when two inputs from different directories
+    share a name, the later ones get a "-2", "-3"... suffix.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+#include <iostream>
+
+//==============================================================================
+namespace {
+
+    struct Settings {
+        juce::MemoryBlock state;                                    //plugin state, or...
+        std::vector<std::pair<juce::String, float>> parameters;     //...an XML preset
+        juce::File outputDirectory;
+        int blockSize = 8192;
+        double segmentSeconds = 60.0;
+        double overlapSeconds = -1.0;                               //< 0: tail + settling + 0.5 s
+        bool pack = false;
+        bool verify = false;
+        float verifyToleranceInDecibels = -60.f;
+    };
+
+    juce::Result loadPreset(const juce::File& file, Settings& settings) {
+        if (!file.existsAsFile())
+            return juce::Result::fail("preset not found: " + file.getFullPathName());
+
+        if (auto xml = juce::parseXMLIfTagMatches(file, "Preset")) {
+            for (auto* parameter : xml->getChildWithTagNameIterator("Parameter"))
+                settings.parameters.emplace_back(parameter->getStringAttribute("id"),
+                                                 (float) parameter->getDoubleAttribute("value"));
+
+            return juce::Result::ok();
+        }
+
+        if (!file.loadFileAsData(settings.state))
+            return juce::Result::fail("can't read preset: " + file.getFullPathName());
+
+        return juce::Result::ok();
+    }
+
+    //one processor per segment (or group of packed segments), configured for an offline render
+    std::unique_ptr<SimpleEQ1AudioProcessor> createProcessor(const Settings& settings, double sampleRate,
+                                                             int numChannels) {
+        auto processor = std::make_unique<SimpleEQ1AudioProcessor>();
+
+        if (settings.state.getSize() > 0)
+            processor->setStateInformation(settings.state.getData(), (int) settings.state.getSize());
+
+        for (auto& [parameterID, value] : settings.parameters) {
+            if (auto* parameter = processor->apvts.getParameter(parameterID))
+                parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+            else
+                std::cerr << "unknown parameter in preset: " << parameterID << std::endl;
+        }
+
+        processor->setNonRealtime(true);
+        processor->setPlayConfigDetails(numChannels, numChannels, sampleRate, settings.blockSize);
+        processor->prepareToPlay(sampleRate, settings.blockSize);
+        return processor;
+    }
+
+    std::unique_ptr<juce::AudioFormatReader> createReader(juce::AudioFormatManager& formats, const juce::File& file) {
+        //memory-mapped where the format supports it (WAV, AIFF), buffered streaming otherwise
+        if (auto* format = formats.findFormatForFileExtension(file.getFileExtension())) {
+            if (std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped { format->createMemoryMappedReader(file) }) {
+                if (mapped->mapEntireFile())
+                    return mapped;
+            }
+        }
+
+        return std::unique_ptr<juce::AudioFormatReader>(formats.createReaderFor(file));
+    }
+
+    juce::Result writeTo(juce::AudioFormat& format, const juce::File& file, const juce::AudioFormatReader& source,
+                         std::unique_ptr<juce::AudioFormatWriter>& writer) {
+        file.deleteFile();
+        auto stream = std::make_unique<juce::FileOutputStream>(file, 1 << 20);
+
+        if (stream->failedToOpen())
+            return juce::Result::fail("can't write " + file.getFullPathName());
+
+        writer.reset(format.createWriterFor(stream.get(), source.sampleRate, source.numChannels,
+                                            (int) source.bitsPerSample, source.metadataValues, 0));
+
+        if (writer == nullptr)
+            return juce::Result::fail("can't write " + file.getFullPathName() + " in this format");
+
+        stream.release();   //owned by the writer now
+        return juce::Result::ok();
+    }
+
+    //==========================================================================
+    //a file being rendered: its segments are rendered into temporary float
+    //WAVs, and whichever segment finishes last stitches them into the output
+    struct FileJob {
+        juce::File input, output;
+        juce::int64 lengthInSamples = 0;
+        double sampleRate = 0.0;
+        int numChannels = 0;
+
+        std::vector<juce::File> segmentFiles;
+        std::atomic<int> segmentsLeft{ 0 };
+
+        //--verify: the file rendered in one piece, and how far the segments are from it
+        juce::File referenceFile;
+        float differenceInDecibels = -100.f;
+
+        std::atomic<bool> failed{ false };
+        juce::String error;
+        juce::CriticalSection errorLock;
+
+        void fail(const juce::String& message) {
+            const juce::ScopedLock sl(errorLock);
+
+            if (!failed.exchange(true))
+                error = message;
+        }
+    };
+
+    //index -1 is the whole file, rendered for --verify
+    struct Segment {
+        FileJob* file;
+        int index;
+        juce::int64 start, length;
+
+        const juce::File& getDestination() const {
+            return index < 0 ? file->referenceFile : file->segmentFiles[(size_t) index];
+        }
+    };
+
+    //renders a group of segments of the same rate and channel count side by
+    //side, each one in its own slice of a processor's channels (a group of
+    //one is a plain render)
+    juce::Result renderSegments(const std::vector<Segment>& group, const Settings& settings,
+                                juce::AudioFormatManager& formats) {
+        jassert(!group.empty());
+
+        const auto sampleRate = group.front().file->sampleRate;
+        const auto numChannels = group.front().file->numChannels;
+
+        auto processor = createProcessor(settings, sampleRate, numChannels * (int) group.size());
+        const auto latency = (juce::int64) processor->getLatencySamples();
+        const auto overlapSeconds = settings.overlapSeconds >= 0.0
+                                  ? settings.overlapSeconds
+                                  : processor->getTailLengthSeconds() + processor->getSettlingTimeSeconds() + 0.5;
+
+        juce::AudioBuffer<float> buffer(numChannels * (int) group.size(), settings.blockSize);
+        juce::MidiBuffer midi;
+        juce::WavAudioFormat wav;
+
+        struct Member {
+            const Segment* segment;
+            std::unique_ptr<juce::AudioFormatReader> reader;
+            std::unique_ptr<juce::AudioFormatWriter> writer;
+            juce::int64 position, samplesToSkip, samplesToWrite;
+        };
+
+        std::vector<Member> members;
+
+        for (auto& segment : group) {
+            auto& file = *segment.file;
+            jassert(file.sampleRate == sampleRate && file.numChannels == numChannels);
+
+            Member member{ &segment, createReader(formats, file.input), nullptr, 0, 0, segment.length };
+
+            if (member.reader == nullptr)
+                return juce::Result::fail("can't read " + file.input.getFullPathName());
+
+            //pre-roll from before the segment (the file's start is true silence before
+            //it, so nothing is lost there), and the latency is read past its end
+            member.position = juce::jmax((juce::int64) 0, segment.start - (juce::int64) (overlapSeconds * sampleRate));
+            member.samplesToSkip = segment.start - member.position + latency;
+
+            //FileOutputStream appends, and a retried segment must start over
+            auto& segmentFile = segment.getDestination();
+            segmentFile.deleteFile();
+
+            auto stream = std::make_unique<juce::FileOutputStream>(segmentFile, 1 << 20);
+
+            if (stream->failedToOpen())
+                return juce::Result::fail("can't write a temporary file in " + settings.outputDirectory.getFullPathName());
+
+            member.writer.reset(wav.createWriterFor(stream.get(), sampleRate, (unsigned int) numChannels, 32, {}, 0));
+
+            if (member.writer == nullptr)
+                return juce::Result::fail("can't create a temporary WAV writer");
+
+            stream.release();
+            members.push_back(std::move(member));
+        }
+
+        auto isFinished = [](const Member& member) { return member.samplesToWrite <= 0; };
+
+        while (!std::all_of(members.begin(), members.end(), isFinished)) {
+            for (size_t i = 0; i < members.size(); ++i) {
+                auto& member = members[i];
+                juce::AudioBuffer<float> slice(buffer.getArrayOfWritePointers() + i * (size_t) numChannels,
+                                               numChannels, settings.blockSize);
+
+                //past the end of the file the reader fills in silence, which lets
+                //the tail out; a finished member just feeds silence until the others are done
+                if (isFinished(member))
+                    slice.clear();
+                else
+                    member.reader->read(&slice, 0, settings.blockSize, member.position, true, true);
+
+                member.position += settings.blockSize;
+            }
+
+            processor->processBlock(buffer, midi);
+
+            for (size_t i = 0; i < members.size(); ++i) {
+                auto& member = members[i];
+
+                if (isFinished(member))
+                    continue;
+
+                juce::AudioBuffer<float> slice(buffer.getArrayOfWritePointers() + i * (size_t) numChannels,
+                                               numChannels, settings.blockSize);
+
+                const auto skip = (int) juce::jmin(member.samplesToSkip, (juce::int64) settings.blockSize);
+                const auto count = (int) juce::jmin(member.samplesToWrite, (juce::int64) (settings.blockSize - skip));
+                member.samplesToSkip -= skip;
+
+                if (count > 0) {
+                    if (!member.writer->writeFromAudioSampleBuffer(slice, skip, count))
+                        return juce::Result::fail("write failed for " + member.segment->file->output.getFullPathName());
+
+                    member.samplesToWrite -= count;
+                }
+            }
+        }
+
+        return juce::Result::ok();
+    }
+
+    juce::Result stitchSegments(FileJob& file, juce::AudioFormatManager& formats) {
+        auto source = createReader(formats, file.input);
+        auto* format = formats.findFormatForFileExtension(file.input.getFileExtension());
+
+        if (source == nullptr || format == nullptr)
+            return juce::Result::fail("can't read " + file.input.getFullPathName());
+
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+        auto result = writeTo(*format, file.output, *source, writer);
+
+        if (result.failed())
+            return result;
+
+        for (auto& segmentFile : file.segmentFiles) {
+            std::unique_ptr<juce::AudioFormatReader> segment(formats.createReaderFor(segmentFile));
+
+            if (segment == nullptr || !writer->writeFromAudioReader(*segment, 0, segment->lengthInSamples))
+                return juce::Result::fail("can't stitch " + file.output.getFullPathName());
+        }
+
+        return juce::Result::ok();
+    }
+
+    //--verify: renders the file again in one piece and compares the segments,
+    //still in their temporary float WAVs, against it
+    juce::Result verifySegments(FileJob& file, const Settings& settings, juce::AudioFormatManager& formats) {
+        auto result = renderSegments({ { &file, -1, 0, file.lengthInSamples } }, settings, formats);
+
+        if (result.failed())
+            return result;
+
+        std::unique_ptr<juce::AudioFormatReader> reference(formats.createReaderFor(file.referenceFile));
+
+        if (reference == nullptr)
+            return juce::Result::fail("can't read the whole-file render of " + file.input.getFullPathName());
+
+        juce::AudioBuffer<float> expected(file.numChannels, settings.blockSize), actual(file.numChannels, settings.blockSize);
+        juce::int64 position = 0;
+        auto largest = 0.f;
+
+        for (auto& segmentFile : file.segmentFiles) {
+            std::unique_ptr<juce::AudioFormatReader> segment(formats.createReaderFor(segmentFile));
+
+            if (segment == nullptr)
+                return juce::Result::fail("can't read back a segment of " + file.input.getFullPathName());
+
+            for (juce::int64 start = 0; start < segment->lengthInSamples; start += settings.blockSize) {
+                const auto count = (int) juce::jmin((juce::int64) settings.blockSize, segment->lengthInSamples - start);
+                segment->read(&actual, 0, count, start, true, true);
+                reference->read(&expected, 0, count, position + start, true, true);
+
+                for (int channel = 0; channel < file.numChannels; ++channel) {
+                    auto* a = actual.getReadPointer(channel);
+                    auto* e = expected.getReadPointer(channel);
+
+                    for (int i = 0; i < count; ++i)
+                        largest = juce::jmax(largest, std::abs(a[i] - e[i]));
+                }
+            }
+
+            position += segment->lengthInSamples;
+        }
+
+        file.differenceInDecibels = juce::Decibels::gainToDecibels(largest);
+
+        if (file.differenceInDecibels > settings.verifyToleranceInDecibels)
+            return juce::Result::fail("segmented render differs from the whole-file render by "
+                                      + juce::String(file.differenceInDecibels, 1) + " dBFS");
+
+        return juce::Result::ok();
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList arguments(argc, argv);
+
+    Settings settings;
+    settings.outputDirectory = arguments.containsOption("--output-dir")
+                             ? arguments.getFileForOption("--output-dir")
+                             : juce::File::getCurrentWorkingDirectory().getChildFile("rendered");
+
+    if (arguments.containsOption("--block"))
+        settings.blockSize = juce::jmax(64, arguments.getValueForOption("--block").getIntValue());
+
+    if (arguments.containsOption("--segment"))
+        settings.segmentSeconds = juce::jmax(1.0, arguments.getValueForOption("--segment").getDoubleValue());
+
+    if (arguments.containsOption("--overlap"))
+        settings.overlapSeconds = juce::jmax(0.0, arguments.getValueForOption("--overlap").getDoubleValue());
+
+    settings.pack = arguments.containsOption("--pack");
+
+    if (arguments.containsOption("--verify")) {
+        settings.verify = true;
+        settings.verifyToleranceInDecibels = arguments.getValueForOption("--verify").getFloatValue();
+    }
+
+    const auto numThreads = arguments.containsOption("--threads")
+                          ? juce::jmax(1, arguments.getValueForOption("--threads").getIntValue())
+                          : juce::SystemStats::getNumCpus();
+
+    if (arguments.containsOption("--preset")) {
+        auto result = loadPreset(arguments.getFileForOption("--preset"), settings);
+
+        if (result.failed()) {
+            std::cerr << result.getErrorMessage() << std::endl;
+            return 1;
+        }
+    }
+
+    //the remaining (non-option) arguments are the input files
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    std::vector<std::unique_ptr<FileJob>> files;
+
+    //what's been taken in the output directory so far, ignoring case so the
+    //result doesn't depend on the file system
+    juce::StringArray outputNames;
+
+    for (int i = 0; i < arguments.size(); ++i) {
+        auto argument = arguments[i];
+
+        if (argument.isOption()) {
+            if (argument != "--pack")
+                ++i;    //every other option takes a value
+
+            continue;
+        }
+
+        auto input = argument.resolveAsFile();
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(input));
+
+        if (reader == nullptr) {
+            std::cerr << "skipping " << input.getFullPathName() << ": not a readable audio file" << std::endl;
+            continue;
+        }
+
+        if (std::any_of(files.begin(), files.end(), [&input](const auto& file) { return file->input == input; })) {
+            std::cerr << "skipping " << input.getFullPathName() << ": already on the list" << std::endl;
+            continue;
+        }
+
+        auto outputName = input.getFileName();
+
+        for (int suffix = 2; outputNames.contains(outputName, true); ++suffix)
+            outputName = input.getFileNameWithoutExtension() + "-" + juce::String(suffix) + input.getFileExtension();
+
+        if (outputName != input.getFileName())
+            std::cerr << "renaming the output of " << input.getFullPathName() << " to " << outputName
+                      << ": another input has the same name" << std::endl;
+
+        outputNames.add(outputName);
+
+        auto file = std::make_unique<FileJob>();
+        file->input = input;
+        file->output = settings.outputDirectory.getChildFile(outputName);
+        file->lengthInSamples = reader->lengthInSamples;
+        file->sampleRate = reader->sampleRate;
+        file->numChannels = (int) reader->numChannels;
+        files.push_back(std::move(file));
+    }
+
+    if (files.empty()) {
+        std::cerr << "usage: SimpleEQ1Render [--preset <file>] [--output-dir <dir>] [--threads <n>]"
+                     " [--block <n>] [--segment <s>] [--overlap <s>] [--pack] [--verify <dB>] <input files...>"
+                  << std::endl;
+        return 1;
+    }
+
+    if (!settings.outputDirectory.createDirectory()) {
+        std::cerr << "can't create " << settings.outputDirectory.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    //every segment is a job; all segments are the same length, except each
+    //file's last one, so the pool stays evenly loaded until the very end
+    std::vector<Segment> segments;
+    double totalSeconds = 0.0;
+
+    for (auto& file : files) {
+        const auto segmentLength = juce::jmax((juce::int64) 1, (juce::int64) (settings.segmentSeconds * file->sampleRate));
+        const auto numSegments = (int) ((file->lengthInSamples + segmentLength - 1) / segmentLength);
+
+        for (int index = 0; index < juce::jmax(1, numSegments); ++index) {
+            const auto start = index * segmentLength;
+            segments.push_back({ file.get(), index, start, juce::jmin(segmentLength, file->lengthInSamples - start) });
+
+            //named after the output, which is unique: getNonexistentChildFile()
+            //only knows about files on disk, not the ones named in this loop
+            file->segmentFiles.push_back(settings.outputDirectory.getNonexistentChildFile(
+                "." + file->output.getFileNameWithoutExtension() + "-" + juce::String(index), ".wav", false));
+        }
+
+        file->segmentsLeft = (int) file->segmentFiles.size();
+
+        if (settings.verify)
+            file->referenceFile = settings.outputDirectory.getNonexistentChildFile(
+                "." + file->output.getFileNameWithoutExtension() + "-whole", ".wav", false);
+
+        totalSeconds += (double) file->lengthInSamples / file->sampleRate;
+    }
+
+    //(34) with --pack, segments that can share a processor are grouped so
+    //they fill its SIMD lanes; mono packs four to a 4-lane register, stereo two
+    if (settings.pack && !createProcessor(settings, 48000.0, 2)->processesChannelsIndependently()) {
+        std::cerr << "--pack ignored: these settings mix channels (Mid/Side, Left/Right, dynamic peak or auto gain)"
+                  << std::endl;
+        settings.pack = false;
+    }
+
+    std::vector<std::vector<Segment>> groups;
+
+    if (settings.pack) {
+        //segments of one format stay together, in order, so the groups are made of
+        //neighbouring (mostly full-length) segments
+        std::stable_sort(segments.begin(), segments.end(), [](const Segment& a, const Segment& b) {
+            return std::make_pair(a.file->sampleRate, a.file->numChannels)
+                 < std::make_pair(b.file->sampleRate, b.file->numChannels);
+        });
+
+        for (auto& segment : segments) {
+            const auto perGroup = juce::jmax((size_t) 1, SimpleEQ1AudioProcessor::getNumLanes() / (size_t) segment.file->numChannels);
+            const auto fits = !groups.empty() && groups.back().size() < perGroup
+                           && groups.back().front().file->sampleRate == segment.file->sampleRate
+                           && groups.back().front().file->numChannels == segment.file->numChannels;
+
+            if (fits)
+                groups.back().push_back(segment);
+            else
+                groups.push_back({ segment });
+        }
+    }
+    else {
+        for (auto& segment : segments)
+            groups.push_back({ segment });
+    }
+
+    juce::ThreadPool pool(numThreads);
+    juce::WaitableEvent finished;
+    std::atomic<int> jobsLeft{ (int) groups.size() };
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    for (auto& group : groups) {
+        pool.addJob([&settings, &formats, &finished, &jobsLeft, group] {
+            //a group renders unless all of its files have already failed
+            auto anyPending = std::any_of(group.begin(), group.end(),
+                                          [](const Segment& segment) { return !segment.file->failed.load(); });
+
+            if (anyPending) {
+                auto result = renderSegments(group, settings, formats);
+
+                //one bad file in a packed group doesn't take the others with it:
+                //they're rendered again one by one, and only the culprit fails
+                if (result.failed() && group.size() > 1) {
+                    for (auto& segment : group) {
+                        auto single = renderSegments({ segment }, settings, formats);
+
+                        if (single.failed())
+                            segment.file->fail(single.getErrorMessage());
+                    }
+                }
+                else if (result.failed()) {
+                    group.front().file->fail(result.getErrorMessage());
+                }
+            }
+
+            for (auto& segment : group) {
+                auto& file = *segment.file;
+
+                if (--file.segmentsLeft == 0) {
+                    if (!file.failed.load()) {
+                        auto result = stitchSegments(file, formats);
+
+                        //a file of one segment was rendered in one piece already
+                        if (result.wasOk() && settings.verify && file.segmentFiles.size() > 1)
+                            result = verifySegments(file, settings, formats);
+
+                        if (result.failed())
+                            file.fail(result.getErrorMessage());
+                    }
+
+                    for (auto& segmentFile : file.segmentFiles)
+                        segmentFile.deleteFile();
+
+                    if (settings.verify)
+                        file.referenceFile.deleteFile();
+                }
+            }
+
+            if (--jobsLeft == 0)
+                finished.signal();
+        });
+    }
+
+    finished.wait();
+    const auto elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) * 0.001;
+
+    int numFailed = 0;
+
+    for (auto& file : files) {
+        if (file->failed.load()) {
+            ++numFailed;
+            std::cerr << "FAILED " << file->input.getFullPathName() << ": " << file->error << std::endl;
+        }
+        else if (settings.verify && file->segmentFiles.size() > 1) {
+            std::cout << file->output.getFullPathName() << " (segments vs whole file: "
+                      << juce::String(file->differenceInDecibels, 1) << " dBFS)" << std::endl;
+        }
+        else {
+            std::cout << file->output.getFullPathName() << std::endl;
+        }
+    }
+
+    std::cout << files.size() << " files, " << totalSeconds << " s of audio in " << elapsedSeconds << " s ("
+              << totalSeconds / juce::jmax(elapsedSeconds, 1.0e-6) << "x realtime, " << numThreads
+              << " threads" << (settings.pack ? ", packed" : "") << ")" << std::endl;
+
+    return numFailed > 0 ? 1 : 0;
+}
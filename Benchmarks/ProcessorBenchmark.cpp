@@ -0,0 +1,366 @@
+/*
+  ==============================================================================
+
+    ProcessorBenchmark.cpp
+
+    Headless benchmark for SimpleEQ1AudioProcessor::processBlock. Sweeps block
+    sizes, sample rates, cut slopes, automation patterns, oversampling
+    factors and the number of extra bands in use (by default a representative
+    subset of 144 cases; --full runs every combination), and reports
+    ns/sample, heap activity per block and the worst callback time as JSON,
+    along with the heap activity of preparing again for a configuration the
+    processor has already seen (which should be none).
+    Given a previous report with --baseline, it exits with a non-zero status
+    when any case got slower (or started allocating), so it can gate builds.
+
+    Options:
+        --output <file>        write the JSON report there instead of stdout
+        --baseline <file>      compare against an earlier report
+        --tolerance <ratio>    allowed slowdown against the baseline (0.1 = 10%)
+        --seconds <s>          audio rendered per case (default 1)
+        --channels <n>         channels per bus (default 2)
+        --quick                fewer cases, for a smoke run
+        --full                 the whole grid (close to 4000 cases), for a
+                               sweep rather than a gate
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <new>
+
+//==============================================================================
+// Heap activity is only counted on the thread that is currently inside a
+// measured processBlock or prepareToPlay call, so the design thread and JUCE's own background
+// threads don't pollute the numbers.
+namespace {
+    thread_local bool countHeapActivity = false;
+    std::atomic<juce::int64> allocationCount{ 0 }, deallocationCount{ 0 };
+
+    void* countedAllocation(std::size_t size) {
+        if (countHeapActivity)
+            allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+        if (auto* pointer = std::malloc(size == 0 ? 1 : size))
+            return pointer;
+
+        throw std::bad_alloc();
+    }
+
+    void countedDeallocation(void* pointer) noexcept {
+        if (pointer != nullptr && countHeapActivity)
+            deallocationCount.fetch_add(1, std::memory_order_relaxed);
+
+        std::free(pointer);
+    }
+}
+
+void* operator new(std::size_t size)                        { return countedAllocation(size); }
+void* operator new[](std::size_t size)                      { return countedAllocation(size); }
+void operator delete(void* pointer) noexcept                { countedDeallocation(pointer); }
+void operator delete[](void* pointer) noexcept              { countedDeallocation(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept   { countedDeallocation(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { countedDeallocation(pointer); }
+
+//==============================================================================
+namespace {
+
+    struct BenchmarkCase {
+        double sampleRate;
+        int blockSize;
+        Slope slope;
+        juce::String automation;
+        int oversamplingIndex;
+        int numBands;
+
+        int getOversamplingFactor() const { return 1 << oversamplingIndex; }
+
+        juce::String getKey() const {
+            return juce::String(sampleRate, 0) + "/" + juce::String(blockSize) + "/"
+                 + juce::String(12 + 12 * (int) slope) + "/" + automation
+                 + "/os" + juce::String(getOversamplingFactor()) + "x"
+                 + "/b" + juce::String(numBands);
+        }
+    };
+
+    struct BenchmarkResult {
+        double nsPerSample = 0.0;
+        double meanCallbackMicroseconds = 0.0;
+        double worstCallbackMicroseconds = 0.0;
+        double worstCallbackBudgetPercent = 0.0;
+        double allocationsPerBlock = 0.0;
+        double deallocationsPerBlock = 0.0;
+        juce::int64 prepareAllocations = 0;     //re-preparing, see runCase
+        juce::var profile;      //per-stage timings, with SIMPLEEQ_ENABLE_PROFILING
+    };
+
+    void setParameter(SimpleEQ1AudioProcessor& processor, const juce::String& parameterID, float value) {
+        auto* parameter = processor.apvts.getParameter(parameterID);
+        jassert(parameter != nullptr);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    //automation is applied between callbacks, like a host does, and isn't timed
+    void applyAutomation(SimpleEQ1AudioProcessor& processor, const juce::String& pattern, double timeInSeconds) {
+        if (pattern == "sweep") {
+            //continuous log sweeps, one cycle per second
+            auto phase = std::sin(juce::MathConstants<double>::twoPi * timeInSeconds) * 0.5 + 0.5;
+            setParameter(processor, "Peak Freq", (float) (100.0 * std::pow(100.0, phase)));
+            setParameter(processor, "LowCut Freq", (float) (20.0 * std::pow(20.0, phase)));
+        }
+        else if (pattern == "jumps") {
+            //a hard step in gain and frequency every 100 ms
+            auto step = (int) (timeInSeconds * 10.0);
+            setParameter(processor, "Peak Gain", (step % 2 == 0) ? 12.f : -12.f);
+            setParameter(processor, "HighCut Freq", (step % 2 == 0) ? 8000.f : 12000.f);
+        }
+    }
+
+    BenchmarkResult runCase(const BenchmarkCase& benchmarkCase, int numChannels, double secondsPerCase) {
+        SimpleEQ1AudioProcessor processor;
+
+        setParameter(processor, "LowCut Freq", 80.f);
+        setParameter(processor, "HighCut Freq", 12000.f);
+        setParameter(processor, "Peak Freq", 1000.f);
+        setParameter(processor, "Peak Gain", 6.f);
+        setParameter(processor, "LowCut Slope", (float) benchmarkCase.slope);
+        setParameter(processor, "HighCut Slope", (float) benchmarkCase.slope);
+        setParameter(processor, "Oversampling", (float) benchmarkCase.oversamplingIndex);
+
+        for (int band = 0; band < benchmarkCase.numBands; ++band) {
+            setParameter(processor, getBandParameterID(band, "On"), 1.f);
+            setParameter(processor, getBandParameterID(band, "Gain"), (band % 2 == 0) ? 3.f : -3.f);
+        }
+
+        processor.setPlayConfigDetails(numChannels, numChannels, benchmarkCase.sampleRate, benchmarkCase.blockSize);
+        processor.prepareToPlay(benchmarkCase.sampleRate, benchmarkCase.blockSize);
+
+        //a host switching to another rate and a smaller block, then back: the
+        //second time round everything should be reset in place, not reallocated
+        const auto otherSampleRate = benchmarkCase.sampleRate == 48000.0 ? 44100.0 : 48000.0;
+        const auto otherBlockSize = juce::jmax(1, benchmarkCase.blockSize / 2);
+
+        processor.prepareToPlay(otherSampleRate, otherBlockSize);
+        processor.prepareToPlay(benchmarkCase.sampleRate, benchmarkCase.blockSize);
+
+        allocationCount = 0;
+        countHeapActivity = true;
+        processor.prepareToPlay(otherSampleRate, otherBlockSize);
+        processor.prepareToPlay(benchmarkCase.sampleRate, benchmarkCase.blockSize);
+        countHeapActivity = false;
+
+        const auto prepareAllocations = allocationCount.load();
+
+        juce::AudioBuffer<float> buffer(numChannels, benchmarkCase.blockSize);
+        juce::MidiBuffer midi;
+        juce::Random random(0x5eed);
+
+        const auto numBlocks = juce::jmax(1, (int) (benchmarkCase.sampleRate * secondsPerCase / benchmarkCase.blockSize));
+        const auto numWarmupBlocks = juce::jmax(1, numBlocks / 10);
+        const auto blockDurationMicroseconds = 1.0e6 * benchmarkCase.blockSize / benchmarkCase.sampleRate;
+
+        double totalNanoseconds = 0.0, worstNanoseconds = 0.0;
+        allocationCount = 0;
+        deallocationCount = 0;
+
+        for (int block = -numWarmupBlocks; block < numBlocks; ++block) {
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < benchmarkCase.blockSize; ++i)
+                    buffer.setSample(channel, i, random.nextFloat() * 2.f - 1.f);
+
+            applyAutomation(processor, benchmarkCase.automation,
+                            (double) (block + numWarmupBlocks) * benchmarkCase.blockSize / benchmarkCase.sampleRate);
+
+            const auto measured = block >= 0;
+            countHeapActivity = measured;
+            const auto start = std::chrono::steady_clock::now();
+
+            processor.processBlock(buffer, midi);
+
+            const auto end = std::chrono::steady_clock::now();
+            countHeapActivity = false;
+
+            if (measured) {
+                auto nanoseconds = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+                totalNanoseconds += nanoseconds;
+                worstNanoseconds = juce::jmax(worstNanoseconds, nanoseconds);
+            }
+        }
+
+        BenchmarkResult result;
+
+       #if SIMPLEEQ_ENABLE_PROFILING
+        result.profile = ProcessingProfiler::toJson(processor.profiler.getStatistics());
+       #endif
+
+        processor.releaseResources();
+
+        result.nsPerSample = totalNanoseconds / ((double) numBlocks * benchmarkCase.blockSize);
+        result.meanCallbackMicroseconds = totalNanoseconds / numBlocks * 1.0e-3;
+        result.worstCallbackMicroseconds = worstNanoseconds * 1.0e-3;
+        result.worstCallbackBudgetPercent = 100.0 * result.worstCallbackMicroseconds / blockDurationMicroseconds;
+        result.allocationsPerBlock = (double) allocationCount.load() / numBlocks;
+        result.deallocationsPerBlock = (double) deallocationCount.load() / numBlocks;
+        result.prepareAllocations = prepareAllocations;
+        return result;
+    }
+
+    enum class Grid { quick, standard, full };
+
+    juce::Array<BenchmarkCase> createCases(Grid grid) {
+        juce::Array<double> sampleRates{ 44100.0, 48000.0, 96000.0, 192000.0 };
+        juce::Array<int> blockSizes{ 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+        juce::Array<Slope> slopes{ Slope_12, Slope_24, Slope_36, Slope_48 };
+        juce::StringArray automations{ "static", "sweep", "jumps" };
+        juce::Array<int> oversamplingIndices{ 0, 1, 2 };
+        juce::Array<int> bandCounts{ 0, 4, BandSettings::maxBands };
+
+        //a low and a high rate, a small, typical and large block, the extremes
+        //of the other ranges, and every automation pattern, since that's where
+        //the per-stride redesign costs show up: 144 cases
+        if (grid == Grid::standard) {
+            sampleRates = { 44100.0, 96000.0 };
+            blockSizes = { 32, 256, 2048 };
+            slopes = { Slope_12, Slope_48 };
+            oversamplingIndices = { 0, 2 };
+            bandCounts = { 0, BandSettings::maxBands };
+        }
+
+        if (grid == Grid::quick) {
+            sampleRates = { 48000.0 };
+            blockSizes = { 32, 512 };
+            slopes = { Slope_12, Slope_48 };
+            bandCounts = { 0, BandSettings::maxBands };
+        }
+
+        juce::Array<BenchmarkCase> cases;
+
+        for (auto sampleRate : sampleRates)
+            for (auto blockSize : blockSizes)
+                for (auto slope : slopes)
+                    for (auto& automation : automations)
+                        for (auto oversamplingIndex : oversamplingIndices)
+                            for (auto numBands : bandCounts)
+                                cases.add({ sampleRate, blockSize, slope, automation, oversamplingIndex, numBands });
+
+        return cases;
+    }
+
+    juce::var toJson(const BenchmarkCase& benchmarkCase, const BenchmarkResult& result) {
+        auto* object = new juce::DynamicObject();
+        object->setProperty("key", benchmarkCase.getKey());
+        object->setProperty("sampleRate", benchmarkCase.sampleRate);
+        object->setProperty("blockSize", benchmarkCase.blockSize);
+        object->setProperty("slopeDbPerOct", 12 + 12 * (int) benchmarkCase.slope);
+        object->setProperty("automation", benchmarkCase.automation);
+        object->setProperty("oversampling", benchmarkCase.getOversamplingFactor());
+        object->setProperty("bands", benchmarkCase.numBands);
+        object->setProperty("nsPerSample", result.nsPerSample);
+        object->setProperty("meanCallbackUs", result.meanCallbackMicroseconds);
+        object->setProperty("worstCallbackUs", result.worstCallbackMicroseconds);
+        object->setProperty("worstCallbackBudgetPercent", result.worstCallbackBudgetPercent);
+        object->setProperty("allocationsPerBlock", result.allocationsPerBlock);
+        object->setProperty("deallocationsPerBlock", result.deallocationsPerBlock);
+        object->setProperty("prepareAllocations", result.prepareAllocations);
+
+        if (!result.profile.isVoid())
+            object->setProperty("profile", result.profile);
+        return juce::var(object);
+    }
+
+    //returns the number of cases that regressed against the baseline report
+    int compareWithBaseline(const juce::var& report, const juce::var& baseline, double tolerance) {
+        std::map<juce::String, juce::var> baselineCases;
+
+        if (auto* baselineResults = baseline["results"].getArray())
+            for (auto& entry : *baselineResults)
+                baselineCases[entry["key"].toString()] = entry;
+
+        int numRegressions = 0;
+
+        if (auto* results = report["results"].getArray()) {
+            for (auto& entry : *results) {
+                auto found = baselineCases.find(entry["key"].toString());
+
+                if (found == baselineCases.end())
+                    continue;
+
+                auto now = (double) entry["nsPerSample"];
+                auto before = (double) found->second["nsPerSample"];
+                auto slower = now > before * (1.0 + tolerance);
+                auto allocates = (double) entry["allocationsPerBlock"] > (double) found->second["allocationsPerBlock"]
+                              || (int) entry["prepareAllocations"] > (int) found->second["prepareAllocations"];
+
+                if (slower || allocates) {
+                    ++numRegressions;
+                    std::cerr << "REGRESSION " << entry["key"].toString()
+                              << ": " << before << " -> " << now << " ns/sample, "
+                              << (double) entry["allocationsPerBlock"] << " allocations/block, "
+                              << (int) entry["prepareAllocations"] << " allocations re-preparing" << std::endl;
+                }
+            }
+        }
+
+        return numRegressions;
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList arguments(argc, argv);
+
+    const auto quick = arguments.containsOption("--quick");
+    const auto grid = quick ? Grid::quick : (arguments.containsOption("--full") ? Grid::full : Grid::standard);
+    const auto seconds = arguments.containsOption("--seconds")
+                       ? arguments.getValueForOption("--seconds").getDoubleValue()
+                       : (quick ? 0.25 : 1.0);
+    const auto numChannels = arguments.containsOption("--channels")
+                           ? juce::jmax(1, arguments.getValueForOption("--channels").getIntValue())
+                           : 2;
+
+    juce::Array<juce::var> results;
+
+    for (auto& benchmarkCase : createCases(grid)) {
+        auto result = runCase(benchmarkCase, numChannels, seconds);
+        results.add(toJson(benchmarkCase, result));
+
+        std::cerr << benchmarkCase.getKey() << ": " << result.nsPerSample << " ns/sample, worst "
+                  << result.worstCallbackMicroseconds << " us, " << result.allocationsPerBlock
+                  << " allocations/block" << std::endl;
+    }
+
+    auto* reportObject = new juce::DynamicObject();
+    reportObject->setProperty("benchmark", "SimpleEQ1AudioProcessor::processBlock");
+    reportObject->setProperty("juceVersion", juce::SystemStats::getJUCEVersion());
+    reportObject->setProperty("cpu", juce::SystemStats::getCpuModel());
+    reportObject->setProperty("numChannels", numChannels);
+    reportObject->setProperty("secondsPerCase", seconds);
+    reportObject->setProperty("results", results);
+    juce::var report(reportObject);
+
+    auto json = juce::JSON::toString(report);
+
+    if (arguments.containsOption("--output"))
+        arguments.getFileForOption("--output").replaceWithText(json);
+    else
+        std::cout << json << std::endl;
+
+    if (arguments.containsOption("--baseline")) {
+        auto baseline = juce::JSON::parse(arguments.getExistingFileForOption("--baseline"));
+        auto tolerance = arguments.containsOption("--tolerance")
+                       ? arguments.getValueForOption("--tolerance").getDoubleValue()
+                       : 0.1;
+
+        if (compareWithBaseline(report, baseline, tolerance) > 0)
+            return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+    AutoGain.cpp
+
+  ==============================================================================
+*/
+
+#include "AutoGain.h"
+
+void AutoGain::setSampleRate(double newSampleRate) noexcept {
+    if (newSampleRate == sampleRate || newSampleRate <= 0.0)
+        return;
+
+    sampleRate = newSampleRate;
+
+    auto broadcast = [](const BiquadCoefficients& section, std::array<Frame, 5>& destination) {
+        destination = { Frame::expand((float) section.b0), Frame::expand((float) section.b1),
+                        Frame::expand((float) section.b2), Frame::expand((float) section.a1),
+                        Frame::expand((float) section.a2) };
+    };
+
+    auto sections = BiquadDesign::makeKWeighting(sampleRate);
+    broadcast(sections[0], shelf);
+    broadcast(sections[1], highPass);
+}
+
+void AutoGain::reset() noexcept {
+    inputEnergy = outputEnergy = 0.0;
+    inputPower = outputPower = 0.0;
+    currentGain = targetGain = gainAtStart = gainAtEnd = 1.f;
+    gainStep = 0.f;
+}
+
+void AutoGain::setEnabled(bool shouldBeEnabled) noexcept {
+    //(33) switching back on starts the meters over, the old estimates belong
+    //to whatever was playing back then
+    if (shouldBeEnabled && !enabled)
+        inputPower = outputPower = 0.0;
+
+    enabled = shouldBeEnabled;
+}
+
+void AutoGain::beginBlock(size_t numSamples) noexcept {
+    jassert(sampleRate > 0.0 && numSamples > 0);
+
+    const auto target = enabled ? targetGain : 1.f;
+    const auto approach = 1.0 - std::exp(-(double) numSamples / (gainSmoothingSeconds * sampleRate));
+
+    gainAtStart = currentGain;
+    gainAtEnd = currentGain + (float) approach * (target - currentGain);
+
+    //close enough is exactly there, so switching off really ends at unity
+    if (std::abs(gainAtEnd - target) < 1.0e-5f)
+        gainAtEnd = target;
+
+    gainStep = (gainAtEnd - gainAtStart) / (float) numSamples;
+}
+
+AutoGain::Frame AutoGain::weight(const std::array<Frame, 5>& shelfSection, const std::array<Frame, 5>& highPassSection,
+                                 Frame sample, Frame (&s1)[2], Frame (&s2)[2]) noexcept {
+    //transposed direct form II, like BiquadCascade
+    for (size_t k = 0; k < 2; ++k) {
+        const auto& c = k == 0 ? shelfSection : highPassSection;
+
+        auto output = (sample * c[0]) + s1[k];
+        s1[k] = (sample * c[1]) - (output * c[3]) + s2[k];
+        s2[k] = (sample * c[2]) - (output * c[4]);
+        sample = output;
+    }
+
+    return sample;
+}
+
+void AutoGain::measureInput(FilterState& state, const Frame* frames, size_t numFrames) noexcept {
+    Frame s1[2] = { state.s1[0], state.s1[1] }, s2[2] = { state.s2[0], state.s2[1] };
+    auto energy = Frame::expand(0.f);
+
+    for (size_t i = 0; i < numFrames; ++i) {
+        auto weighted = weight(shelf, highPass, frames[i], s1, s2);
+        energy += weighted * weighted;
+    }
+
+    std::copy(std::begin(s1), std::end(s1), std::begin(state.s1));
+    std::copy(std::begin(s2), std::end(s2), std::begin(state.s2));
+    inputEnergy += (double) energy.sum();
+}
+
+void AutoGain::processOutput(FilterState& state, Frame* frames, size_t offset, size_t numFrames) noexcept {
+    Frame s1[2] = { state.s1[0], state.s1[1] }, s2[2] = { state.s2[0], state.s2[1] };
+    auto energy = Frame::expand(0.f);
+    auto gain = gainAtStart + gainStep * (float) offset;
+
+    //(33) the meter listens to the filters' output, before the make-up gain,
+    //otherwise the gain would be measuring itself
+    for (size_t i = 0; i < numFrames; ++i) {
+        auto weighted = weight(shelf, highPass, frames[i], s1, s2);
+        energy += weighted * weighted;
+
+        frames[i] = frames[i] * Frame::expand(gain);
+        gain += gainStep;
+    }
+
+    std::copy(std::begin(s1), std::end(s1), std::begin(state.s1));
+    std::copy(std::begin(s2), std::end(s2), std::begin(state.s2));
+    outputEnergy += (double) energy.sum();
+}
+
+void AutoGain::endBlock(size_t numSamples) noexcept {
+    jassert(sampleRate > 0.0 && numSamples > 0);
+
+    currentGain = gainAtEnd;
+
+    //(33) one-pole averages of the mean square, summed over the channels
+    //(BS.1770 weights the front channels equally)
+    const auto decay = std::exp(-(double) numSamples / (integrationSeconds * sampleRate));
+    inputPower = decay * inputPower + (1.0 - decay) * inputEnergy / (double) numSamples;
+    outputPower = decay * outputPower + (1.0 - decay) * outputEnergy / (double) numSamples;
+    inputEnergy = outputEnergy = 0.0;
+
+    //(33) loudness is -0.691 + 10 log10(mean square); the gate works on that,
+    //the gain only needs the ratio of the two powers
+    const auto gatePower = std::pow(10.0, ((double) gateInLufs + 0.691) / 10.0);
+
+    if (enabled && inputPower > gatePower && outputPower > 0.0) {
+        const auto maxGain = juce::Decibels::decibelsToGain((double) maxGainInDecibels);
+        targetGain = (float) juce::jlimit(1.0 / maxGain, maxGain, std::sqrt(inputPower / outputPower));
+    }
+}
@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    AutoGain.h
+
+    Loudness compensation after the last filter stage: K-weighted meters
+    (ITU-R BS.1770) on the chain's input and output, and a smoothed make-up
+    gain that brings the output back to the input's loudness, so boosting or
+    cutting doesn't make a comparison against the bypassed signal misleading.
+
+    It works on the processor's interleaved SIMD frames: the input meter runs
+    over them right after interleaving, and the output meter and the gain
+    share one pass right before deinterleaving, while the frames are still in
+    cache. The host buffer isn't traversed any more than without it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadDesign.h"
+
+class AutoGain {
+public:
+    using Frame = juce::dsp::SIMDRegister<float>;
+
+    //(33) the compensation never goes further than the "Peak Gain" range
+    static constexpr float maxGainInDecibels = 24.f;
+
+    //(33) below this input loudness (LUFS) the gain holds still, so a fade
+    //out or a pause doesn't send it chasing the noise floor
+    static constexpr float gateInLufs = -70.f;
+
+    //(33) the meters integrate over about the BS.1770 short-term window,
+    //and the gain follows them a little faster than that
+    static constexpr double integrationSeconds = 3.0;
+    static constexpr double gainSmoothingSeconds = 0.5;
+
+    //(33) one group of lanes' K-weighting state, for one of the two meters
+    struct FilterState {
+        Frame s1[2]{}, s2[2]{};
+    };
+
+    //(33) the processor keeps one of these per group of lanes, in its arena
+    struct GroupState {
+        FilterState input, output;
+    };
+
+    //(33) the K-weighting and the ballistics depend on the processing rate
+    //(which includes oversampling); only redesigns when it actually changed
+    void setSampleRate(double newSampleRate) noexcept;
+
+    //(33) unity gain and empty meters
+    void reset() noexcept;
+
+    //(33) switched off, the gain glides back to unity before it stops being applied
+    void setEnabled(bool shouldBeEnabled) noexcept;
+    bool isActive() const noexcept { return enabled || currentGain != 1.f; }
+
+    //(33) the gain ramp over the next numSamples, which every group follows
+    void beginBlock(size_t numSamples) noexcept;
+
+    //(33) adds the K-weighted energy of the frames to the input meter
+    void measureInput(FilterState& state, const Frame* frames, size_t numFrames) noexcept;
+
+    //(33) adds the K-weighted energy of the frames to the output meter and
+    //applies the make-up gain, in the same pass. offset is where the frames
+    //start within the block given to beginBlock().
+    void processOutput(FilterState& state, Frame* frames, size_t offset, size_t numFrames) noexcept;
+
+    //(33) folds the block's energy into the meters and works out the next target
+    void endBlock(size_t numSamples) noexcept;
+
+private:
+    //(33) the two K-weighting sections applied to one frame, returning the weighted frame
+    static Frame weight(const std::array<Frame, 5>& shelf, const std::array<Frame, 5>& highPass,
+                        Frame sample, Frame (&s1)[2], Frame (&s2)[2]) noexcept;
+
+    double sampleRate{ 0.0 };
+    std::array<Frame, 5> shelf{}, highPass{};   //b0, b1, b2, a1, a2, broadcast to every lane
+
+    bool enabled{ false };
+
+    //energy of the current block, summed over every channel
+    double inputEnergy{ 0.0 }, outputEnergy{ 0.0 };
+
+    //mean square loudness estimates
+    double inputPower{ 0.0 }, outputPower{ 0.0 };
+
+    float currentGain{ 1.f }, targetGain{ 1.f };
+    float gainAtStart{ 1.f }, gainAtEnd{ 1.f }, gainStep{ 0.f };
+};
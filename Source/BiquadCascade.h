@@ -0,0 +1,193 @@
+/*
+  ==============================================================================
+
+    BiquadCascade.h
+
+    A fixed-capacity cascade of second-order sections that runs every active
+    section on each sample in a single pass over the buffer, with the
+    coefficients and filter state held in locals (registers) for the whole
+    block. The number of active sections is dispatched to a compile-time
+    specialisation, so the inner loop is fully unrolled for every slope
+    combination.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "CoefficientHandoff.h"
+
+template <typename SampleType, int MaxSections>
+class BiquadCascade {
+public:
+    using NumericType = typename juce::dsp::SampleTypeHelpers::ElementType<SampleType>::Type;
+
+    static constexpr int maxSections = MaxSections;
+
+    BiquadCascade() {
+        for (int slot = 0; slot < MaxSections; ++slot)
+            setSection(slot, {});
+
+        reset();
+    }
+
+    //(19) coefficients for one slot, broadcast to every lane
+    void setSection(int slot, const BiquadCoefficients& coefficients) noexcept {
+        jassert(juce::isPositiveAndBelow(slot, MaxSections));
+
+        b0[(size_t) slot] = broadcast(static_cast<NumericType>(coefficients.b0));
+        b1[(size_t) slot] = broadcast(static_cast<NumericType>(coefficients.b1));
+        b2[(size_t) slot] = broadcast(static_cast<NumericType>(coefficients.b2));
+        a1[(size_t) slot] = broadcast(static_cast<NumericType>(coefficients.a1));
+        a2[(size_t) slot] = broadcast(static_cast<NumericType>(coefficients.a2));
+    }
+
+    //(27) coefficients for one slot of a single lane, so different channels
+    //can run different filters through the same pass
+    void setSection(int slot, size_t lane, const BiquadCoefficients& coefficients) noexcept {
+        jassert(juce::isPositiveAndBelow(slot, MaxSections));
+
+        setLane(b0[(size_t) slot], lane, static_cast<NumericType>(coefficients.b0));
+        setLane(b1[(size_t) slot], lane, static_cast<NumericType>(coefficients.b1));
+        setLane(b2[(size_t) slot], lane, static_cast<NumericType>(coefficients.b2));
+        setLane(a1[(size_t) slot], lane, static_cast<NumericType>(coefficients.a1));
+        setLane(a2[(size_t) slot], lane, static_cast<NumericType>(coefficients.a2));
+    }
+
+    //(29) one lane's state for a slot. With the same coefficients and the same
+    //structure, a section can move to a cascade of another precision and carry
+    //on exactly where it was, instead of restarting from silence (a click).
+    NumericType getState(int slot, size_t lane, bool second) const noexcept {
+        jassert(juce::isPositiveAndBelow(slot, MaxSections));
+        return getLane(second ? s2[(size_t) slot] : s1[(size_t) slot], lane);
+    }
+
+    void setState(int slot, size_t lane, NumericType first, NumericType second) noexcept {
+        jassert(juce::isPositiveAndBelow(slot, MaxSections));
+        setLane(s1[(size_t) slot], lane, first);
+        setLane(s2[(size_t) slot], lane, second);
+    }
+
+    //(19) inactive slots cost nothing; a slot that gets switched back on
+    //starts from a clean state instead of whatever it held when it was switched off
+    void setSectionActive(int slot, bool shouldBeActive) noexcept {
+        jassert(juce::isPositiveAndBelow(slot, MaxSections));
+
+        if (active[(size_t) slot] == shouldBeActive)
+            return;
+
+        active[(size_t) slot] = shouldBeActive;
+
+        if (shouldBeActive)
+            s1[(size_t) slot] = s2[(size_t) slot] = broadcast(0);
+
+        numActive = 0;
+
+        for (int i = 0; i < MaxSections; ++i)
+            if (active[(size_t) i])
+                activeSlots[(size_t) numActive++] = i;
+    }
+
+    int getNumActiveSections() const noexcept { return numActive; }
+    bool isSectionActive(int slot) const noexcept { return active[(size_t) slot]; }
+
+    void reset() noexcept {
+        s1.fill(broadcast(0));
+        s2.fill(broadcast(0));
+    }
+
+    //(19) filters the frames in place through every active section
+    //(29) the frames may be of a narrower type than the cascade (float samples
+    //through a double cascade) and Stride apart, so a single lane of an
+    //interleaved buffer can be filtered on its own
+    template <size_t Stride = 1, typename FrameType>
+    void process(FrameType* frames, size_t numFrames) noexcept {
+        dispatch<MaxSections, Stride>(frames, numFrames);
+    }
+
+private:
+    static SampleType broadcast(NumericType value) noexcept {
+        if constexpr (std::is_same<SampleType, NumericType>::value)
+            return value;
+        else
+            return SampleType::expand(value);
+    }
+
+    static void setLane(SampleType& destination, size_t lane, NumericType value) noexcept {
+        if constexpr (std::is_same<SampleType, NumericType>::value) {
+            jassert(lane == 0);
+            juce::ignoreUnused(lane);
+            destination = value;
+        }
+        else {
+            destination.set(lane, value);
+        }
+    }
+
+    static NumericType getLane(const SampleType& source, size_t lane) noexcept {
+        if constexpr (std::is_same<SampleType, NumericType>::value) {
+            jassert(lane == 0);
+            juce::ignoreUnused(lane);
+            return source;
+        }
+        else {
+            return source.get(lane);
+        }
+    }
+
+    //(19) picks the specialisation matching the number of active sections
+    template <int NumSections, size_t Stride, typename FrameType>
+    void dispatch(FrameType* frames, size_t numFrames) noexcept {
+        if constexpr (NumSections == 0) {
+            juce::ignoreUnused(frames, numFrames);
+        }
+        else {
+            if (numActive == NumSections)
+                processSections<NumSections, Stride>(frames, numFrames);
+            else
+                dispatch<NumSections - 1, Stride>(frames, numFrames);
+        }
+    }
+
+    //(19) transposed direct form II, the same structure as juce::dsp::IIR::Filter,
+    //but every section is applied to a sample before moving on to the next one
+    template <int NumSections, size_t Stride, typename FrameType>
+    void processSections(FrameType* frames, size_t numFrames) noexcept {
+        SampleType lb0[NumSections], lb1[NumSections], lb2[NumSections], la1[NumSections], la2[NumSections];
+        SampleType lv1[NumSections], lv2[NumSections];
+
+        for (int k = 0; k < NumSections; ++k) {
+            auto slot = (size_t) activeSlots[(size_t) k];
+            lb0[k] = b0[slot]; lb1[k] = b1[slot]; lb2[k] = b2[slot];
+            la1[k] = a1[slot]; la2[k] = a2[slot];
+            lv1[k] = s1[slot]; lv2[k] = s2[slot];
+        }
+
+        for (size_t i = 0; i < numFrames; ++i) {
+            auto sample = static_cast<SampleType>(frames[i * Stride]);
+
+            for (int k = 0; k < NumSections; ++k) {
+                auto output = (sample * lb0[k]) + lv1[k];
+                lv1[k] = (sample * lb1[k]) - (output * la1[k]) + lv2[k];
+                lv2[k] = (sample * lb2[k]) - (output * la2[k]);
+                sample = output;
+            }
+
+            frames[i * Stride] = static_cast<FrameType>(sample);
+        }
+
+        for (int k = 0; k < NumSections; ++k) {
+            auto slot = (size_t) activeSlots[(size_t) k];
+            s1[slot] = lv1[k];
+            s2[slot] = lv2[k];
+        }
+    }
+
+    //structure-of-arrays storage, indexed by slot
+    std::array<SampleType, MaxSections> b0, b1, b2, a1, a2;
+    std::array<SampleType, MaxSections> s1, s2;
+
+    std::array<bool, MaxSections> active{};
+    std::array<int, MaxSections> activeSlots{};
+    int numActive = 0;
+};
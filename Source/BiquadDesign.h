@@ -0,0 +1,183 @@
+/*
+  ==============================================================================
+
+    BiquadDesign.h
+
+    Closed-form, allocation-free biquad designs. They follow the same
+    formulas as juce::dsp::IIR::Coefficients / juce::dsp::FilterDesign, so
+    switching between the two never produces a jump in the response, but
+    they write straight into a BiquadCoefficients instead of allocating a
+    reference-counted Coefficients object. That makes them cheap enough to
+    call on the audio thread while a parameter is being smoothed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "CoefficientHandoff.h"
+
+namespace BiquadDesign {
+
+    //(16) normalise a raw (b0, b1, b2, a0, a1, a2) set by a0
+    inline BiquadCoefficients normalised(double b0, double b1, double b2,
+                                         double a0, double a1, double a2) noexcept {
+        auto a0Inverse = 1.0 / a0;
+        return { b0 * a0Inverse, b1 * a0Inverse, b2 * a0Inverse,
+                 a1 * a0Inverse, a2 * a0Inverse };
+    }
+
+    //(25) the part of a peak filter that only depends on its frequency and Q.
+    //Once it's been worked out, a new gain is a square root and a handful of
+    //multiplies away, which is what the dynamic EQ needs every sub-block.
+    struct PeakPrototype {
+        double alpha{ 0.0 }, c2{ -2.0 };
+
+        static PeakPrototype make(double sampleRate, double frequency, double quality) noexcept {
+            jassert(sampleRate > 0.0 && frequency > 0.0 && frequency <= sampleRate * 0.5 && quality > 0.0);
+
+            auto omega = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+            return { std::sin(omega) / (quality * 2.0), -2.0 * std::cos(omega) };
+        }
+
+        BiquadCoefficients withGain(double gainFactor) const noexcept {
+            auto A = std::sqrt(juce::jmax(0.0, gainFactor));
+            auto alphaTimesA = alpha * A;
+            auto alphaOverA = alpha / A;
+
+            return normalised(1.0 + alphaTimesA, c2, 1.0 - alphaTimesA,
+                              1.0 + alphaOverA, c2, 1.0 - alphaOverA);
+        }
+    };
+
+    //(16) same as juce::dsp::IIR::Coefficients<float>::makePeakFilter
+    inline BiquadCoefficients makePeak(double sampleRate, double frequency,
+                                       double quality, double gainFactor) noexcept {
+        return PeakPrototype::make(sampleRate, frequency, quality).withGain(gainFactor);
+    }
+
+    //(25) same as juce::dsp::IIR::Coefficients<float>::makeBandPass (0 dB peak)
+    inline BiquadCoefficients makeBandPass(double sampleRate, double frequency, double quality) noexcept {
+        jassert(sampleRate > 0.0 && frequency > 0.0 && frequency <= sampleRate * 0.5 && quality > 0.0);
+
+        auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        auto nSquared = n * n;
+        auto invQ = 1.0 / quality;
+        auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+        return normalised(c1 * n * invQ, 0.0, -c1 * n * invQ,
+                          1.0, c1 * 2.0 * (1.0 - nSquared), c1 * (1.0 - invQ * n + nSquared));
+    }
+
+    //(16) same as juce::dsp::IIR::Coefficients<float>::makeLowPass
+    inline BiquadCoefficients makeLowPass(double sampleRate, double frequency, double quality) noexcept {
+        jassert(sampleRate > 0.0 && frequency > 0.0 && frequency <= sampleRate * 0.5 && quality > 0.0);
+
+        auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        auto nSquared = n * n;
+        auto invQ = 1.0 / quality;
+        auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+        return normalised(c1, c1 * 2.0, c1,
+                          1.0, c1 * 2.0 * (1.0 - nSquared), c1 * (1.0 - invQ * n + nSquared));
+    }
+
+    //(16) same as juce::dsp::IIR::Coefficients<float>::makeHighPass
+    inline BiquadCoefficients makeHighPass(double sampleRate, double frequency, double quality) noexcept {
+        jassert(sampleRate > 0.0 && frequency > 0.0 && frequency <= sampleRate * 0.5 && quality > 0.0);
+
+        auto n = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        auto nSquared = n * n;
+        auto invQ = 1.0 / quality;
+        auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+        return normalised(c1, c1 * -2.0, c1,
+                          1.0, c1 * 2.0 * (nSquared - 1.0), c1 * (1.0 - invQ * n + nSquared));
+    }
+
+    //(26) same as juce::dsp::IIR::Coefficients<float>::makeNotch
+    inline BiquadCoefficients makeNotch(double sampleRate, double frequency, double quality) noexcept {
+        jassert(sampleRate > 0.0 && frequency > 0.0 && frequency <= sampleRate * 0.5 && quality > 0.0);
+
+        auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        auto nSquared = n * n;
+        auto invQ = 1.0 / quality;
+        auto c1 = 1.0 / (1.0 + n * invQ + nSquared);
+        auto b0 = c1 * (1.0 + nSquared);
+        auto b1 = 2.0 * c1 * (1.0 - nSquared);
+
+        return normalised(b0, b1, b0,
+                          1.0, b1, c1 * (1.0 - n * invQ + nSquared));
+    }
+
+    //(26) same as juce::dsp::IIR::Coefficients<float>::makeLowShelf / makeHighShelf
+    inline BiquadCoefficients makeShelf(bool isHighShelf, double sampleRate, double frequency,
+                                        double quality, double gainFactor) noexcept {
+        jassert(sampleRate > 0.0 && frequency > 0.0 && frequency <= sampleRate * 0.5 && quality > 0.0);
+
+        auto A = juce::jmax(0.0, std::sqrt(gainFactor));
+        auto aMinus1 = A - 1.0;
+        auto aPlus1 = A + 1.0;
+        auto omega = juce::MathConstants<double>::twoPi * juce::jmax(frequency, 2.0) / sampleRate;
+        auto coso = std::cos(omega);
+        auto beta = std::sin(omega) * std::sqrt(A) / quality;
+        auto aMinus1TimesCoso = aMinus1 * coso;
+
+        if (isHighShelf)
+            return normalised(A * (aPlus1 + aMinus1TimesCoso + beta),
+                              A * -2.0 * (aMinus1 + aPlus1 * coso),
+                              A * (aPlus1 + aMinus1TimesCoso - beta),
+                              aPlus1 - aMinus1TimesCoso + beta,
+                              2.0 * (aMinus1 - aPlus1 * coso),
+                              aPlus1 - aMinus1TimesCoso - beta);
+
+        return normalised(A * (aPlus1 - aMinus1TimesCoso + beta),
+                          A * 2.0 * (aMinus1 - aPlus1 * coso),
+                          A * (aPlus1 - aMinus1TimesCoso - beta),
+                          aPlus1 + aMinus1TimesCoso + beta,
+                          -2.0 * (aMinus1 + aPlus1 * coso),
+                          aPlus1 + aMinus1TimesCoso - beta);
+    }
+
+    //(16) same cascade as FilterDesign<float>::designIIR*HighOrderButterworthMethod
+    //for an even order of (numSections * 2); only the first numSections are written
+    inline void makeButterworthCascade(bool isHighPass, double sampleRate, double frequency,
+                                       int numSections, std::array<BiquadCoefficients, 4>& sections) noexcept {
+        jassert(numSections >= 1 && numSections <= (int) sections.size());
+
+        auto order = numSections * 2;
+
+        for (int i = 0; i < numSections; ++i) {
+            auto quality = 1.0 / (2.0 * std::cos((2.0 * i + 1.0) * juce::MathConstants<double>::pi / (order * 2.0)));
+
+            sections[(size_t) i] = isHighPass ? makeHighPass(sampleRate, frequency, quality)
+                                              : makeLowPass(sampleRate, frequency, quality);
+        }
+    }
+
+    //(33) the ITU-R BS.1770 K-weighting: a +4 dB high shelf (the head) and the
+    //"RLB" high-pass, derived from their analog prototypes so any rate works
+    //(at 48 kHz it matches the coefficients published in the standard)
+    inline std::array<BiquadCoefficients, 2> makeKWeighting(double sampleRate) noexcept {
+        jassert(sampleRate > 0.0);
+
+        const auto pi = juce::MathConstants<double>::pi;
+
+        auto k = std::tan(pi * 1681.974450955533 / sampleRate);
+        auto q = 0.7071752369554196;
+        auto vh = std::pow(10.0, 3.999843853973347 / 20.0);
+        auto vb = std::pow(vh, 0.4996667741545416);
+
+        auto shelf = normalised(vh + vb * k / q + k * k, 2.0 * (k * k - vh), vh - vb * k / q + k * k,
+                                1.0 + k / q + k * k, 2.0 * (k * k - 1.0), 1.0 - k / q + k * k);
+
+        k = std::tan(pi * 38.13547087602444 / sampleRate);
+        q = 0.5003270373238773;
+
+        //the standard leaves the numerator unnormalised (unity gain well above the cutoff)
+        auto a0 = 1.0 + k / q + k * k;
+        BiquadCoefficients highPass{ 1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0 };
+
+        return { shelf, highPass };
+    }
+}
@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    ButterworthCache.cpp
+
+  ==============================================================================
+*/
+
+#include "ButterworthCache.h"
+
+ButterworthCache::ButterworthCache()
+    //(30) everything is allocated up front: a miss fills a free entry, or
+    //recycles the oldest one once they're all taken
+    : entries((size_t) capacity), table((size_t) tableSize, emptySlot) {
+}
+
+size_t ButterworthCache::KeyHash::operator()(const Key& key) const noexcept {
+    auto hash = std::hash<double>()(key.sampleRate);
+    hash = hash * 31 + std::hash<float>()(key.frequency);
+    hash = hash * 31 + (size_t) key.numSections;
+    hash = hash * 2 + (key.isHighPass ? 1 : 0);
+
+    //(30) the table only looks at the low bits, and some standard libraries
+    //hash a float to its bit pattern, whose low bits are all zero for whole
+    //frequencies: a 64-bit finaliser spreads every bit over them
+    auto mixed = (juce::uint64) hash;
+    mixed = (mixed ^ (mixed >> 33)) * 0xff51afd7ed558ccdULL;
+    mixed = (mixed ^ (mixed >> 33)) * 0xc4ceb9fe1a85ec53ULL;
+    return (size_t) (mixed ^ (mixed >> 33));
+}
+
+void ButterworthCache::design(bool isHighPass, double sampleRate, float frequency,
+                              int numSections, std::array<BiquadCoefficients, 4>& sections) {
+    const Key key{ sampleRate, frequency, numSections, isHighPass };
+    const juce::ScopedLock sl(lock);
+
+    auto slot = findSlot(key);
+
+    if (const auto found = table[(size_t) slot]; found != emptySlot) {
+        auto& entry = entries[(size_t) found];
+        std::copy_n(entry.sections.begin(), numSections, sections.begin());
+
+        unlink(found);
+        pushFront(found);
+        ++numHits;
+        return;
+    }
+
+    ++numMisses;
+    BiquadDesign::makeButterworthCascade(isHighPass, sampleRate, frequency, numSections, sections);
+
+    int recycled;
+
+    if (numEntries < capacity) {
+        recycled = numEntries++;
+    }
+    else {
+        recycled = tail;
+        unlink(recycled);
+        eraseSlot(findSlot(entries[(size_t) recycled].key));
+
+        //erasing may have shifted the slot the new key goes in
+        slot = findSlot(key);
+    }
+
+    auto& entry = entries[(size_t) recycled];
+    entry.key = key;
+    std::copy_n(sections.begin(), numSections, entry.sections.begin());
+
+    table[(size_t) slot] = recycled;
+    pushFront(recycled);
+}
+
+int ButterworthCache::findSlot(const Key& key) const noexcept {
+    constexpr auto mask = (size_t) tableSize - 1;
+
+    for (auto slot = KeyHash()(key) & mask;; slot = (slot + 1) & mask) {
+        const auto entry = table[slot];
+
+        if (entry == emptySlot || entries[(size_t) entry].key == key)
+            return (int) slot;
+    }
+}
+
+//(30) backward-shift deletion: the entries after the hole that would have
+//landed in it (or before it) move up, so lookups never need tombstones
+void ButterworthCache::eraseSlot(int slot) noexcept {
+    constexpr auto mask = (size_t) tableSize - 1;
+    auto hole = (size_t) slot;
+
+    for (auto next = (hole + 1) & mask; table[next] != emptySlot; next = (next + 1) & mask) {
+        const auto home = KeyHash()(entries[(size_t) table[next]].key) & mask;
+
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            table[hole] = table[next];
+            hole = next;
+        }
+    }
+
+    table[hole] = emptySlot;
+}
+
+void ButterworthCache::unlink(int entry) noexcept {
+    auto& e = entries[(size_t) entry];
+
+    if (e.previous >= 0)
+        entries[(size_t) e.previous].next = e.next;
+    else
+        head = e.next;
+
+    if (e.next >= 0)
+        entries[(size_t) e.next].previous = e.previous;
+    else
+        tail = e.previous;
+
+    e.previous = e.next = -1;
+}
+
+void ButterworthCache::pushFront(int entry) noexcept {
+    auto& e = entries[(size_t) entry];
+    e.previous = -1;
+    e.next = head;
+
+    if (head >= 0)
+        entries[(size_t) head].previous = entry;
+
+    head = entry;
+
+    if (tail < 0)
+        tail = entry;
+}
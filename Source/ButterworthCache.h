@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    ButterworthCache.h
+
+    A bounded least-recently-used cache of Butterworth cut designs, shared by
+    every plugin instance in the process. The cut frequencies move in 1 Hz
+    steps and the slope is one of four choices, so recalling a preset or
+    replaying automation keeps asking for the same designs: those become a
+    lookup instead of a round of trig.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadDesign.h"
+
+class ButterworthCache {
+public:
+    //(30) about 350 kB, enough for every slope over a few hundred frequencies
+    //at each of the rates a session runs at (host rate times oversampling)
+    static constexpr int capacity = 2048;
+
+    ButterworthCache();
+
+    //(30) same result as BiquadDesign::makeButterworthCascade. Takes a lock,
+    //so it's for the design thread (and offline rendering), never for the
+    //audio thread's smoothing ramps.
+    void design(bool isHighPass, double sampleRate, float frequency,
+                int numSections, std::array<BiquadCoefficients, 4>& sections);
+
+    juce::int64 getNumHits() const noexcept { return numHits.load(); }
+    juce::int64 getNumMisses() const noexcept { return numMisses.load(); }
+
+private:
+    struct Key {
+        double sampleRate;
+        float frequency;
+        int numSections;
+        bool isHighPass;
+
+        bool operator==(const Key& other) const noexcept {
+            return sampleRate == other.sampleRate && frequency == other.frequency
+                && numSections == other.numSections && isHighPass == other.isHighPass;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const noexcept;
+    };
+
+    //(30) the entries form a doubly linked list by index, most recent first,
+    //and a full cache reuses the least recently used entry in place
+    struct Entry {
+        Key key;
+        std::array<BiquadCoefficients, 4> sections;
+        int previous{ -1 }, next{ -1 };
+    };
+
+    //(30) the index is an open-addressing hash table of entry numbers, with
+    //linear probing. At twice the capacity it's never more than half full,
+    //so the probe sequences stay short.
+    static constexpr int tableSize = 2 * capacity;
+    static constexpr int emptySlot = -1;
+
+    static_assert((tableSize & (tableSize - 1)) == 0, "the table is indexed with a mask");
+
+    //where key is in the table, or the empty slot it would go in
+    int findSlot(const Key& key) const noexcept;
+    void eraseSlot(int slot) noexcept;
+
+    void unlink(int entry) noexcept;
+    void pushFront(int entry) noexcept;
+
+    juce::CriticalSection lock;
+    std::vector<Entry> entries;
+    std::vector<int> table;
+    int numEntries{ 0 };
+    int head{ -1 }, tail{ -1 };
+
+    std::atomic<juce::int64> numHits{ 0 }, numMisses{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE(ButterworthCache)
+};
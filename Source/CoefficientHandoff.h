@@ -0,0 +1,185 @@
+/*
+  ==============================================================================
+
+    CoefficientHandoff.h
+
+    Plain coefficient storage and the wait-free mailbox used to hand newly
+    designed filter coefficients from the design thread to the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <complex>
+
+//(15) one second-order section, already normalised by a0
+//(same layout as juce::dsp::IIR::Coefficients stores a biquad internally)
+//(29) kept in double: float cascades round them when they're loaded, the
+//double-precision ones need every digit of a pole sitting right next to z = 1
+struct BiquadCoefficients {
+    double b0{ 1.0 }, b1{ 0.0 }, b2{ 0.0 },
+           a1{ 0.0 }, a2{ 0.0 };
+
+    static BiquadCoefficients fromJuce(const juce::dsp::IIR::Coefficients<float>& coefficients) {
+        jassert(coefficients.getFilterOrder() == 2);
+        auto* raw = coefficients.getRawCoefficients();
+        return { raw[0], raw[1], raw[2], raw[3], raw[4] };
+    }
+
+    //(20) |H(e^jw)| of this section at the given frequency
+    double getMagnitudeForFrequency(double frequency, double sampleRate) const noexcept {
+        auto omega = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+        auto z1 = std::polar(1.0, -omega), z2 = z1 * z1;
+
+        auto numerator = b0 + b1 * z1 + b2 * z2;
+        auto denominator = 1.0 + a1 * z1 + a2 * z2;
+
+        return std::abs(numerator) / std::abs(denominator);
+    }
+
+    //(28) magnitude of the larger pole (roots of z^2 + a1 z + a2): the section's
+    //impulse response dies away like radius^n
+    double getPoleRadius() const noexcept {
+        auto discriminant = a1 * a1 - 4.0 * a2;
+
+        if (discriminant < 0.0)
+            return std::sqrt(a2);
+
+        auto root = std::sqrt(discriminant);
+        return 0.5 * juce::jmax(std::abs(-a1 + root), std::abs(-a1 - root));
+    }
+};
+
+//(15) everything the audio thread needs to configure a MonoChain.
+//Each stage carries a generation number which is bumped whenever that stage
+//gets redesigned, so the audio thread only touches the stages that changed.
+struct CoefficientSet {
+    //(26) the N-band engine's extra bands, on top of the peak
+    static constexpr int maxBands = 16;
+
+    std::array<BiquadCoefficients, 4> lowCut, highCut;
+    BiquadCoefficients peak;
+
+    //(26) bit n is set when band n is switched on
+    std::array<BiquadCoefficients, maxBands> bands;
+    juce::uint32 activeBands{ 0 };
+
+    int lowCutSlope{ 0 },
+        highCutSlope{ 0 };
+
+    //(29) cut stages whose poles crowd z = 1 run in double precision
+    bool lowCutInDouble{ false },
+         highCutInDouble{ false };
+
+    //(21) the rate these were designed for, which includes oversampling
+    double sampleRate{ 0.0 };
+    int oversamplingIndex{ 0 };
+
+    //(26) one per chain position: low cut, peak, high cut, bands
+    std::array<juce::uint32, 4> generations{};
+
+    bool isBandActive(int band) const noexcept { return (activeBands & (1u << band)) != 0; }
+
+    //(20) visits the sections that are switched on, in processing order
+    template <typename Callback>
+    void forEachActiveSection(Callback&& callback) const {
+        for (int i = 0; i <= lowCutSlope; ++i)
+            callback(lowCut[(size_t) i]);
+
+        callback(peak);
+
+        for (int band = 0; band < maxBands; ++band)
+            if (isBandActive(band))
+                callback(bands[(size_t) band]);
+
+        for (int i = 0; i <= highCutSlope; ++i)
+            callback(highCut[(size_t) i]);
+    }
+
+    //(20) magnitude of the whole cascade at the given frequency
+    double getMagnitudeForFrequency(double frequency, double sampleRate) const {
+        double magnitude = 1.0;
+        forEachActiveSection([&](const BiquadCoefficients& section) {
+            magnitude *= section.getMagnitudeForFrequency(frequency, sampleRate);
+        });
+        return magnitude;
+    }
+
+    //(28) samples until the cascade's impulse response has decayed by
+    //decayInDecibels. The sections are in series, so their tails add up.
+    double getTailLengthInSamples(double decayInDecibels) const {
+        const auto logDecay = std::log(juce::Decibels::decibelsToGain(-decayInDecibels, -1000.0));
+        double samples = 0.0;
+
+        forEachActiveSection([&](const BiquadCoefficients& section) {
+            //the FIR part of a section is two samples long
+            samples += 2.0;
+
+            auto radius = juce::jmin(section.getPoleRadius(), 1.0 - 1.0e-9);
+
+            if (radius > 0.0)
+                samples += logDecay / std::log(radius);
+        });
+
+        return samples;
+    }
+};
+
+//(27) what actually goes through the mailbox: one CoefficientSet per channel
+//set. The second one is only used in the Mid/Side and Left/Right modes, where
+//it's the side (or right) channel's filter; otherwise it mirrors the first.
+struct ChannelCoefficients {
+    static constexpr int numSets = 2;
+
+    std::array<CoefficientSet, numSets> sets;
+    int channelMode{ 0 };
+
+    //(27) true when both sets ended up with the same coefficients, so the
+    //audio thread can broadcast the first set instead of filling lanes one by one
+    bool setsMatch{ true };
+};
+
+//(15) wait-free single-producer/single-consumer "latest value" mailbox.
+//The producer fills getWriteBuffer() and calls publish(); the consumer calls
+//acquire(), which returns the most recently published value (or nullptr if
+//nothing new arrived). Neither side ever blocks, allocates or frees.
+template <typename ValueType>
+class TripleBuffer {
+public:
+    ValueType& getWriteBuffer() noexcept { return buffers[backIndex]; }
+
+    void publish() noexcept {
+        auto previous = middle.exchange(backIndex | newDataFlag, std::memory_order_acq_rel);
+        backIndex = previous & indexMask;
+    }
+
+    const ValueType* acquire() noexcept {
+        if ((middle.load(std::memory_order_acquire) & newDataFlag) == 0)
+            return nullptr;
+
+        auto previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & indexMask;
+        return &buffers[frontIndex];
+    }
+
+private:
+    static constexpr int indexMask = 3, newDataFlag = 4;
+
+    ValueType buffers[3];
+    std::atomic<int> middle{ 1 };
+    int backIndex{ 0 }, frontIndex{ 2 };
+};
+
+//(15) one background thread shared by every plugin instance in the process,
+//which runs the (allocating) filter design off the audio thread
+struct CoefficientDesignThread : public juce::TimeSliceThread {
+    CoefficientDesignThread() : juce::TimeSliceThread("SimpleEQ coefficient design") {
+        startThread();
+    }
+
+    ~CoefficientDesignThread() override {
+        stopThread(1000);
+    }
+};
@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    DynamicPeak.cpp
+
+  ==============================================================================
+*/
+
+#include "DynamicPeak.h"
+
+void DynamicPeak::prepare(double newSampleRate, float* scratch, size_t scratchSize) {
+    jassert(scratch != nullptr && scratchSize > 0);
+
+    sampleRate = newSampleRate;
+    keyScratch = scratch;
+    keyScratchSize = scratchSize;
+
+    detector.setSectionActive(0, true);
+    detectorFrequency = detectorQuality = 0.f;
+    for (auto& cached : prototypes)
+        cached.sampleRate = 0.0;
+
+    setParameters(parameters);
+    reset();
+}
+
+void DynamicPeak::reset() {
+    detector.reset();
+    envelope = 0.f;
+}
+
+void DynamicPeak::setParameters(const Parameters& newParameters) {
+    parameters = newParameters;
+
+    //one-pole ballistics, reaching 1 - 1/e of a step in the given time
+    auto coefficientFor = [this](float milliseconds) {
+        return (float) std::exp(-1.0 / (juce::jmax(0.01, (double) milliseconds) * 0.001 * sampleRate));
+    };
+
+    if (sampleRate > 0.0) {
+        attackCoefficient = coefficientFor(parameters.attackMs);
+        releaseCoefficient = coefficientFor(parameters.releaseMs);
+    }
+}
+
+float DynamicPeak::process(const juce::dsp::AudioBlock<const float>& key, float frequency, float quality) {
+    const auto numChannels = key.getNumChannels();
+    const auto numSamples = key.getNumSamples();
+
+    if (numChannels > 0 && numSamples > 0) {
+        //(25) the band only moves while it's being smoothed
+        if (frequency != detectorFrequency || quality != detectorQuality) {
+            auto nyquistSafe = juce::jmin((double) frequency, sampleRate * 0.49);
+            detector.setSection(0, BiquadDesign::makeBandPass(sampleRate, nyquistSafe, quality));
+            detectorFrequency = frequency;
+            detectorQuality = quality;
+        }
+
+        const auto capacity = keyScratchSize;
+        const auto gain = 1.f / (float) numChannels;
+
+        for (size_t start = 0; start < numSamples; start += capacity) {
+            const auto length = juce::jmin(capacity, numSamples - start);
+            auto* mono = keyScratch;
+
+            juce::FloatVectorOperations::copyWithMultiply(mono, key.getChannelPointer(0) + start, gain, (int) length);
+
+            for (size_t channel = 1; channel < numChannels; ++channel)
+                juce::FloatVectorOperations::addWithMultiply(mono, key.getChannelPointer(channel) + start, gain, (int) length);
+
+            detector.process(mono, length);
+
+            for (size_t i = 0; i < length; ++i) {
+                auto level = std::abs(mono[i]);
+                auto coefficient = level > envelope ? attackCoefficient : releaseCoefficient;
+                envelope = level + coefficient * (envelope - level);
+            }
+        }
+    }
+
+    //(25) the static curve: above the threshold, every dB of overshoot moves
+    //the band by (1 - 1/ratio) dB, up to the full "Peak Gain"
+    auto overshoot = juce::Decibels::gainToDecibels(envelope, -100.f) - parameters.thresholdInDecibels;
+
+    if (overshoot <= 0.f)
+        return 0.f;
+
+    return overshoot * (1.f - 1.f / juce::jmax(1.f, parameters.ratio));
+}
+
+BiquadCoefficients DynamicPeak::designPeak(int channelSet, double processingSampleRate, float frequency, float quality,
+                                           float gainInDecibels) {
+    auto& cached = prototypes[(size_t) channelSet];
+
+    if (frequency != cached.frequency || quality != cached.quality || processingSampleRate != cached.sampleRate) {
+        cached.prototype = BiquadDesign::PeakPrototype::make(processingSampleRate, frequency, quality);
+        cached.frequency = frequency;
+        cached.quality = quality;
+        cached.sampleRate = processingSampleRate;
+    }
+
+    return cached.prototype.withGain(juce::Decibels::decibelsToGain(gainInDecibels));
+}
@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    DynamicPeak.h
+
+    Dynamic EQ mode for the peak band: a band-pass envelope follower on the
+    key signal (the main input or the sidechain bus) decides how much of the
+    "Peak Gain" is applied, so the band behaves like a frequency-selective
+    compressor (negative gain) or expander (positive gain).
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadDesign.h"
+#include "BiquadCascade.h"
+
+class DynamicPeak {
+public:
+    struct Parameters {
+        float thresholdInDecibels{ -20.f },
+              ratio{ 2.f },
+              attackMs{ 10.f },
+              releaseMs{ 100.f };
+    };
+
+    //(25) sampleRate is the rate of the key signal, i.e. the host rate
+    //(32) the key is mixed down into scratch, which the caller owns; longer
+    //blocks are taken scratchSize samples at a time
+    void prepare(double sampleRate, float* scratch, size_t scratchSize);
+    void reset();
+
+    void setParameters(const Parameters& newParameters);
+
+    //(25) runs the key through the detector, which listens to the same band as
+    //the peak filter, and returns how far (in dB) the band should move for
+    //the next sub-block: 0 below the threshold, growing with the overshoot above it
+    //(27) the amount is the same for every channel set, each one clamps it
+    //to its own "Peak Gain" with getGainInDecibels()
+    float process(const juce::dsp::AudioBlock<const float>& key, float frequency, float quality);
+
+    static float getGainInDecibels(float amount, float maxGainInDecibels) noexcept {
+        return maxGainInDecibels < 0.f ? -juce::jmin(amount, -maxGainInDecibels)
+                                       : juce::jmin(amount, maxGainInDecibels);
+    }
+
+    //(25) peak coefficients for that gain at the processing rate; the
+    //frequency/Q dependent part is only recomputed when one of them moves
+    //(27) and cached per channel set
+    BiquadCoefficients designPeak(int channelSet, double processingSampleRate, float frequency, float quality,
+                                  float gainInDecibels);
+
+private:
+    double sampleRate{ 0.0 };
+    float* keyScratch{ nullptr };
+    size_t keyScratchSize{ 0 };
+
+    BiquadCascade<float, 1> detector;
+    float detectorFrequency{ 0.f }, detectorQuality{ 0.f };
+
+    struct CachedPrototype {
+        BiquadDesign::PeakPrototype prototype;
+        float frequency{ 0.f }, quality{ 0.f };
+        double sampleRate{ 0.0 };
+    };
+
+    std::array<CachedPrototype, 2> prototypes;
+
+    Parameters parameters;
+    float attackCoefficient{ 0.f }, releaseCoefficient{ 0.f };
+    float envelope{ 0.f };
+};
@@ -0,0 +1,181 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEngine.cpp
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseEngine.h"
+
+void LinearPhaseEngine::prepare(const juce::dsp::ProcessSpec& spec) {
+    const auto numPairs = ((size_t) spec.numChannels + 1) / 2;
+
+    //(32) nothing it depends on changed, so it only starts over from silence
+    if (spec.sampleRate == sampleRate && spec.maximumBlockSize == preparedBlockSize
+        && numPairs == convolutions.size()) {
+        reset();
+        return;
+    }
+
+    sampleRate = spec.sampleRate;
+    preparedBlockSize = spec.maximumBlockSize;
+    kernelSize = getKernelSizeFor(sampleRate);
+    kernelLoaded.store(false);
+    processedSinceReset = false;
+
+    //(32) the FFT, the window and the convolution engines all allocate, so
+    //they're only set up when a kernel is actually loaded: with the
+    //linear-phase mode off, a new rate or block size costs nothing here
+    enginesPrepared = false;
+
+    if (convolutions.size() != numPairs) {
+        convolutions.clear();
+
+        for (size_t i = 0; i < numPairs; ++i)
+            convolutions.push_back(std::make_unique<juce::dsp::Convolution>(messageQueue));
+    }
+}
+
+void LinearPhaseEngine::prepareEngines() {
+    //(32) one FFT per kernel length, kept for when the session goes back to that rate
+    const auto order = (size_t) juce::roundToInt(std::log2(kernelSize));
+    jassert(order < ffts.size());
+
+    if (ffts[order] == nullptr)
+        ffts[order] = std::make_unique<juce::dsp::FFT>((int) order);
+
+    fft = ffts[order].get();
+
+    //(32) these keep their capacity, so only a longer kernel than before allocates
+    fftData.assign((size_t) kernelSize * 2, 0.f);
+    window.assign((size_t) kernelSize, 0.f);
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), (size_t) kernelSize,
+                                                             juce::dsp::WindowingFunction<float>::blackmanHarris,
+                                                             false);
+
+    for (auto& convolution : convolutions)
+        convolution->prepare({ sampleRate, preparedBlockSize, 2 });
+
+    enginesPrepared = true;
+}
+
+void LinearPhaseEngine::reset() {
+    processedSinceReset = false;
+
+    //(32) engines without a kernel may not even be prepared, and haven't run since
+    if (!kernelLoaded.load())
+        return;
+
+    for (auto& convolution : convolutions)
+        convolution->reset();
+}
+
+void LinearPhaseEngine::process(juce::dsp::AudioBlock<float>& block, bool midSide) {
+    const auto numChannels = block.getNumChannels();
+    processedSinceReset = true;
+
+    //(27) the kernels are Mid and Side filters here, so the pair is encoded first
+    midSide = midSide && numChannels == 2;
+
+    if (midSide)
+        encodeMidSide(block);
+
+    for (size_t pair = 0; pair < convolutions.size() && pair * 2 < numChannels; ++pair) {
+        auto pairBlock = block.getSubsetChannelBlock(pair * 2, juce::jmin((size_t) 2, numChannels - pair * 2));
+        juce::dsp::ProcessContextReplacing<float> context(pairBlock);
+        convolutions[pair]->process(context);
+    }
+
+    if (midSide)
+        decodeMidSide(block);
+}
+
+void LinearPhaseEngine::encodeMidSide(juce::dsp::AudioBlock<float>& block) noexcept {
+    auto* left = block.getChannelPointer(0);
+    auto* right = block.getChannelPointer(1);
+
+    for (size_t i = 0; i < block.getNumSamples(); ++i) {
+        auto mid = 0.5f * (left[i] + right[i]);
+        right[i] = 0.5f * (left[i] - right[i]);
+        left[i] = mid;
+    }
+}
+
+void LinearPhaseEngine::decodeMidSide(juce::dsp::AudioBlock<float>& block) noexcept {
+    auto* mid = block.getChannelPointer(0);
+    auto* side = block.getChannelPointer(1);
+
+    for (size_t i = 0; i < block.getNumSamples(); ++i) {
+        auto left = mid[i] + side[i];
+        side[i] = mid[i] - side[i];
+        mid[i] = left;
+    }
+}
+
+void LinearPhaseEngine::loadKernel(const CoefficientSet& first, const CoefficientSet& second) {
+    if (kernelSize == 0)
+        return;
+
+    //(32) the audio thread doesn't touch the engines until kernelLoaded is set,
+    //so preparing them here (on the design thread) can't race with process()
+    if (!enginesPrepared)
+        prepareEngines();
+
+    juce::AudioBuffer<float> kernel(2, kernelSize);
+    designKernel(first, kernel.getWritePointer(0));
+
+    //(27) identical sets share one design
+    if (&first == &second)
+        kernel.copyFrom(1, 0, kernel, 0, 0, kernelSize);
+    else
+        designKernel(second, kernel.getWritePointer(1));
+
+    for (auto& convolution : convolutions) {
+        juce::AudioBuffer<float> copy(kernel);
+        convolution->loadImpulseResponse(std::move(copy), sampleRate,
+                                         juce::dsp::Convolution::Stereo::yes,
+                                         juce::dsp::Convolution::Trim::no,
+                                         juce::dsp::Convolution::Normalise::no);
+    }
+
+    ++numKernelsLoaded;
+    kernelLoaded.store(true);
+}
+
+void LinearPhaseEngine::installLoadedKernel() {
+    const auto latest = numKernelsLoaded.load();
+
+    if (processedSinceReset || !kernelLoaded.load() || latest == installedKernel)
+        return;
+
+    //(20) Convolution::prepare() runs the queued loads on this thread and
+    //starts on the newest engine, without a crossfade. There's no filter
+    //state to lose yet, so that's exactly what an offline render wants.
+    for (auto& convolution : convolutions)
+        convolution->prepare({ sampleRate, preparedBlockSize, 2 });
+
+    installedKernel = latest;
+}
+
+void LinearPhaseEngine::designKernel(const CoefficientSet& coefficients, float* destination) {
+    //(20) zero-phase spectrum: the cascade's magnitude at every bin, no phase
+    std::fill(fftData.begin(), fftData.end(), 0.f);
+
+    for (int bin = 0; bin <= kernelSize / 2; ++bin) {
+        auto frequency = juce::jmax(1.0, bin * sampleRate / kernelSize);
+        fftData[(size_t) bin * 2] = (float) coefficients.getMagnitudeForFrequency(frequency, coefficients.sampleRate);
+    }
+
+    fft->performRealOnlyInverseTransform(fftData.data());
+
+    //(20) the impulse is centred on sample 0, so rotate it to the middle of
+    //the kernel (which makes it causal) and taper the ends
+    for (int i = 0; i < kernelSize; ++i)
+        destination[i] = fftData[(size_t) ((i + kernelSize / 2) % kernelSize)] * window[(size_t) i];
+}
+
+//(20) long enough to resolve the lowest cut frequencies (about 170 ms)
+int LinearPhaseEngine::getKernelSizeFor(double sampleRate) {
+    return juce::nextPowerOfTwo(juce::roundToInt(sampleRate * 0.17));
+}
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEngine.h
+
+    Optional linear-phase mode: an FIR kernel with the magnitude response of
+    the current IIR cascade and zero phase, run through juce::dsp::Convolution
+    (uniformly partitioned FFT convolution). Kernels are built on the design
+    thread and the convolution engines crossfade to them in the background.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientHandoff.h"
+
+class LinearPhaseEngine {
+public:
+    //(20) spec.numChannels is the number of channels that will be processed
+    //(32) only allocates for a new channel count; whatever the kernel needs
+    //is built by the next loadKernel()
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset();
+
+    //(20) audio thread: convolves the block in place
+    //(27) with midSide set, a stereo block is filtered as Mid (left kernel) and Side (right kernel)
+    void process(juce::dsp::AudioBlock<float>& block, bool midSide = false);
+
+    //(20) design thread: builds a kernel for the coefficients and queues it on
+    //every convolution engine, which crossfade to it without blocking
+    //(27) one kernel per channel of each pair; pass the same set twice for both
+    void loadKernel(const CoefficientSet& first, const CoefficientSet& second);
+
+    //(20) offline rendering only, with the design thread kept out: when
+    //nothing has been processed since prepare() or reset(), swaps the last
+    //loaded kernel in at once instead of crossfading into it whenever the
+    //background loader gets round to it, so a render always starts on the
+    //FIR. Allocates.
+    void installLoadedKernel();
+
+    //the kernel is symmetric, so its centre tap sets the latency
+    int getLatencyInSamples() const noexcept { return kernelSize / 2; }
+    bool hasKernel() const noexcept { return kernelLoaded.load(); }
+
+private:
+    static int getKernelSizeFor(double sampleRate);
+    void prepareEngines();
+    void designKernel(const CoefficientSet& coefficients, float* destination);
+
+    static void encodeMidSide(juce::dsp::AudioBlock<float>& block) noexcept;
+    static void decodeMidSide(juce::dsp::AudioBlock<float>& block) noexcept;
+
+    double sampleRate{ 0.0 };
+    juce::uint32 preparedBlockSize{ 0 };
+    int kernelSize{ 0 };
+
+    //must outlive the convolutions, it runs their background loading
+    juce::dsp::ConvolutionMessageQueue messageQueue;
+
+    //one stereo convolution per pair of channels
+    std::vector<std::unique_ptr<juce::dsp::Convolution>> convolutions;
+
+    //(32) indexed by order; fft points at the one for the current kernel length
+    std::array<std::unique_ptr<juce::dsp::FFT>, 20> ffts;
+    juce::dsp::FFT* fft{ nullptr };
+    std::vector<float> fftData, window;
+    std::atomic<bool> kernelLoaded{ false };
+    bool enginesPrepared{ false };          //design thread, or with the audio stopped
+
+    //(20) loadKernel() counts the kernels, installLoadedKernel() remembers
+    //the last one it swapped in
+    std::atomic<juce::uint32> numKernelsLoaded{ 0 };
+    juce::uint32 installedKernel{ 0 };
+    bool processedSinceReset{ false };      //audio thread only
+};
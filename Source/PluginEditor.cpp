@@ -11,11 +11,28 @@
 
 //==============================================================================
 SimpleEQ1AudioProcessorEditor::SimpleEQ1AudioProcessorEditor (SimpleEQ1AudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), audioProcessor (p),
+      analyzer (p.preEqFifo, p.postEqFifo, p),
+      spectrumDisplay (analyzer),
+      responseCurve (p),
+      controls (p)
+     #if SIMPLEEQ_ENABLE_PROFILING
+      , profilerOverlay (p.profiler)
+     #endif
 {
+    addAndMakeVisible (spectrumDisplay);
+    addAndMakeVisible (responseCurve);
+    addAndMakeVisible (controls);
+
+   #if SIMPLEEQ_ENABLE_PROFILING
+    addAndMakeVisible (profilerOverlay);
+   #endif
+
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (400, 300);
+    setResizable (true, true);
+    setResizeLimits (400, 400, 1600, 1200);
+    setSize (600, 600);
 }
 
 SimpleEQ1AudioProcessorEditor::~SimpleEQ1AudioProcessorEditor()
@@ -27,14 +44,17 @@ void SimpleEQ1AudioProcessorEditor::paint (juce::Graphics& g)
 {
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-
-    g.setColour (juce::Colours::white);
-    g.setFont (15.0f);
-    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
 }
 
 void SimpleEQ1AudioProcessorEditor::resized()
 {
-    // This is generally where you'll want to lay out the positions of any
-    // subcomponents in your editor..
+    //(23) spectrum on top, the parameter controls below
+    auto bounds = getLocalBounds();
+    spectrumDisplay.setBounds (bounds.removeFromTop (bounds.getHeight() / 3));
+    responseCurve.setBounds (spectrumDisplay.getBounds());
+    controls.setBounds (bounds);
+
+   #if SIMPLEEQ_ENABLE_PROFILING
+    profilerOverlay.setBounds (spectrumDisplay.getBounds().removeFromRight (360).removeFromTop (140));
+   #endif
 }
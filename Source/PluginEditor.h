@@ -10,6 +10,7 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "ResponseCurve.h"
 
 //==============================================================================
 /**
@@ -29,5 +30,15 @@ private:
     // access the processor object that created it.
     SimpleEQ1AudioProcessor& audioProcessor;
 
+    //(23) the analyzer (and its taps) only exist while the editor does
+    SpectrumAnalyzer analyzer;
+    SpectrumDisplay spectrumDisplay;
+    ResponseCurveDisplay responseCurve;     //(24) drawn on top of the spectrum
+    juce::GenericAudioProcessorEditor controls;
+
+   #if SIMPLEEQ_ENABLE_PROFILING
+    ProfilerOverlay profilerOverlay;        //(31) over the top-right corner of the analyzer
+   #endif
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleEQ1AudioProcessorEditor)
 };
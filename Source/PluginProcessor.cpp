@@ -18,14 +18,63 @@ SimpleEQ1AudioProcessor::SimpleEQ1AudioProcessor()
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                      #if ! JucePlugin_IsSynth
+                       //(25) optional key input for the dynamic peak
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
+                      #endif
                      #endif
                        )
 #endif
 {
+    //(14) listen to every parameter so we know which stage needs a redesign
+    markAllStagesDirty();
+
+    linearPhaseParameter = apvts.getRawParameterValue("Linear Phase");
+    oversamplingParameter = apvts.getRawParameterValue("Oversampling");
+    channelModeParameter = apvts.getRawParameterValue("Channel Mode");
+    dynamicParameter = apvts.getRawParameterValue("Dynamic");
+    dynamicSidechainParameter = apvts.getRawParameterValue("Dynamic Sidechain");
+    dynamicThresholdParameter = apvts.getRawParameterValue("Dynamic Threshold");
+    dynamicRatioParameter = apvts.getRawParameterValue("Dynamic Ratio");
+    dynamicAttackParameter = apvts.getRawParameterValue("Dynamic Attack");
+    dynamicReleaseParameter = apvts.getRawParameterValue("Dynamic Release");
+    autoGainParameter = apvts.getRawParameterValue("Auto Gain");
+
+    for (auto* param : getParameters())
+        if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(param))
+            apvts.addParameterListener(withID->paramID, this);
+
+    //(22) lookup tables for the binary state. Two IDs sharing a hash can't be
+    //told apart in it, so those entries are never restored from it, and the
+    //state is saved as XML (which stores the IDs themselves) instead
+    for (auto* param : getParameters()) {
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(param)) {
+            const auto hash = ranged->paramID.hashCode();
+
+            if (stateParameterIndexByHash.count(hash) != 0) {
+                jassertfalse;   //rename one of the parameters
+                stateParameterIndexByHash[hash] = ambiguousStateEntry;
+                binaryStateIsUnambiguous = false;
+            }
+            else {
+                stateParameterIndexByHash[hash] = stateParameters.size();
+            }
+
+            stateParameters.push_back(ranged);
+        }
+    }
+
+    designThread->addTimeSliceClient(this);
 }
 
 SimpleEQ1AudioProcessor::~SimpleEQ1AudioProcessor()
 {
+    //(15) blocks until the design thread is no longer running our callback
+    designThread->removeTimeSliceClient(this);
+
+    for (auto* param : getParameters())
+        if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(param))
+            apvts.removeParameterListener(withID->paramID, this);
 }
 
 //==============================================================================
@@ -61,9 +110,10 @@ bool SimpleEQ1AudioProcessor::isMidiEffect() const
    #endif
 }
 
+//(28) worked out by the design thread from the current coefficients
 double SimpleEQ1AudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return tailLengthSeconds.load();
 }
 
 int SimpleEQ1AudioProcessor::getNumPrograms()
@@ -93,21 +143,139 @@ void SimpleEQ1AudioProcessor::changeProgramName (int index, const juce::String&
 //==============================================================================
 void SimpleEQ1AudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    //(4) prepare the filters to use (=pass the process spec) +add its attributes
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1; //each monochain can handle only 1 channel...
+    //(4) prepare the filters to use
+    //(18) one chain per group of SIMD lanes
+    const auto numChannels = (size_t) juce::jmax(1, getMainBusNumOutputChannels());
+
+    //(27) the channel modes need exactly two channels
+    isStereoLayout.store(numChannels == 2);
+    activeChannelMode = Channels_Stereo;
+
+    //(32) the chains, precise lanes and scratch buffers, reset in place
+    prepareArena(numChannels, samplesPerBlock);
+
+    //(19) the peak section is always on
+    for (auto& chain : simdChains)
+        chain.setSectionActive(PeakSlot, true);
+
+    lowCutInDouble = highCutInDouble = false;
 
-    //prepare the L and R monochain to run with the spec parameters...
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    //(21) polyphase IIR half-band oversamplers, with an integer latency so it
+    //can be reported exactly. The design thread asks them for their latency,
+    //so they're only ever rebuilt under designLock.
+    {
+        const juce::ScopedLock lock(designLock);
+
+        if (oversamplingChannels != numChannels) {
+            for (size_t factor = 1; factor < oversamplers.size(); ++factor)
+                oversamplers[factor] = std::make_unique<juce::dsp::Oversampling<float>>(
+                    numChannels, factor, juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, true, true);
+
+            oversamplingChannels = numChannels;
+            oversamplingBlockSize = 0;
+        }
+
+        //(32) the half-band filters don't depend on the rate, so their buffers
+        //only have to be rebuilt for a bigger block
+        for (size_t factor = 1; factor < oversamplers.size(); ++factor) {
+            if (samplesPerBlock > oversamplingBlockSize)
+                oversamplers[factor]->initProcessing((size_t) samplesPerBlock);
+
+            oversamplers[factor]->reset();
+        }
+
+        oversamplingBlockSize = juce::jmax(oversamplingBlockSize, samplesPerBlock);
+    }
+
+    activeOversampling = 0;
+    processingSampleRate = sampleRate;
+
+    //(25) the detector runs on the key signal, at the host rate
+    dynamicPeak.prepare(sampleRate, keyScratch.data(), keyScratch.size());
+    dynamicWasActive = false;
+
+    //(33) the make-up gain starts from unity, the meters from nothing
+    autoGain.reset();
+
+    //(16) start the ramps from the current values, there's nothing to smooth yet
+    const auto channelSettings = getChannelSettings();
+
+    for (size_t set = 0; set < smoothedSettings.size(); ++set)
+        smoothedSettings[set].reset(sampleRate, smoothingTimeSeconds.load(), channelSettings[set]);
+
+    //the sample rate may have changed, so every stage has to be redesigned
+    //(15) the audio thread isn't running yet, so we can apply the result straight away
+    designSampleRate.store(sampleRate);
+    {
+        const juce::ScopedLock lock(designLock);
+        markAllStagesDirty();
+        updateFilters();
+
+        //(20) the FIR kernel length depends on the sample rate
+        linearPhaseEngine.prepare({ sampleRate, (juce::uint32) samplesPerBlock, (juce::uint32) numChannels });
+        lastKernelUpdateTime = 0;
+        updateLinearPhaseKernel();
+        updateLatency();
+        updateTailLength();
+    }
+    applyPendingCoefficients();
+    linearPhaseWasActive = false;
 
-    updateFilters();
+    silentSamples = 0;
+    silenceBypassed = false;
 
     
 }
 
+//(32) lays everything the audio thread works on out in the arena, in one go.
+//It's sized for the most channels and the biggest block seen so far (not
+//necessarily at the same time), so going back to any earlier configuration
+//carves the same memory again and the objects start over from a clean state.
+void SimpleEQ1AudioProcessor::prepareArena(size_t numChannels, int samplesPerBlock) {
+    constexpr auto numLanes = SIMDFloat::size();
+
+    auto numBytesFor = [](size_t channels, size_t blockSize) {
+        const auto groups = (channels + numLanes - 1) / numLanes;
+
+        return ProcessingArena::bytesFor<MonoChain>(groups)
+             + ProcessingArena::bytesFor<PreciseLane>(groups * numLanes)
+             + ProcessingArena::bytesFor<AutoGain::GroupState>(groups)
+             + ProcessingArena::bytesFor<SIMDFloat>(blockSize * maxOversamplingFactor)
+             + ProcessingArena::bytesFor<float*>(channels)
+             + channels * ProcessingArena::bytesFor<float>(blockSize)
+             + ProcessingArena::bytesFor<float>(blockSize);
+    };
+
+    const auto numConversionChannels = (size_t) juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels(),
+                                                           (int) numChannels);
+
+    arenaChannels = juce::jmax(arenaChannels, numConversionChannels);
+    arenaBlockSize = juce::jmax(arenaBlockSize, samplesPerBlock);
+    arena.reserve(numBytesFor(arenaChannels, (size_t) arenaBlockSize));
+    arena.rewind();
+
+    const auto numGroups = (numChannels + numLanes - 1) / numLanes;
+    simdChains = { arena.carve<MonoChain>(numGroups), numGroups };
+    preciseLanes = { arena.carve<PreciseLane>(numGroups * numLanes), numGroups * numLanes };
+    autoGainStates = { arena.carve<AutoGain::GroupState>(numGroups), numGroups };
+
+    //(17) the interleaving scratch space
+    //(21) big enough for an oversampled block
+    const auto numFrames = (size_t) samplesPerBlock * maxOversamplingFactor;
+    interleaved = { arena.carve<SIMDFloat>(numFrames), numFrames };
+
+    //(29) the double processBlock's conversion channels
+    conversionChannels = { arena.carve<float*>(numConversionChannels), numConversionChannels };
+
+    for (auto& channel : conversionChannels)
+        channel = arena.carve<float>((size_t) samplesPerBlock);
+
+    conversionBlockSize = samplesPerBlock;
+
+    //(25) the dynamic peak mixes the key down into this
+    keyScratch = { arena.carve<float>((size_t) samplesPerBlock), (size_t) samplesPerBlock };
+}
+
 void SimpleEQ1AudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
@@ -122,17 +290,18 @@ bool SimpleEQ1AudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
     return true;
   #else
     // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-    return false;
+    //(18) the filter engine doesn't care about the channel count, so any
+    //layout (mono, stereo, surround, ambisonics...) is fine as long as it
+    //has at least one channel.
+    if (layouts.getMainOutputChannelSet().isDisabled())
+        return false;
 
     // This checks if the input layout matches the output layout
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+
+    //(25) the sidechain is only ever mixed down to mono, so it can be anything
    #endif
 
     return true;
@@ -143,6 +312,7 @@ bool SimpleEQ1AudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
 void SimpleEQ1AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    SIMPLEEQ_PROFILE_BLOCK(profiler, buffer.getNumSamples(), getSampleRate());
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -157,20 +327,407 @@ void SimpleEQ1AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, ju
 
 
     //(13) refactoring made it so easy to just call....
-    updateFilters();
-    
+    //(15) ...but in realtime the design happens on the design thread and here
+    //we only pick up whatever it published. When rendering
+    //offline there are no realtime constraints and we want automation to keep
+    //up with the render speed, so we design inline.
+    if (isNonRealtime()) {
+        SIMPLEEQ_PROFILE_STAGE(profiler, Design);
+        const juce::ScopedLock lock(designLock);
+        runDesignPass();
+    }
+
+    //(5) create an audio block to wrap the buffer
+    //(18) only the main bus channels get filtered
+    auto block = juce::dsp::AudioBlock<float>(buffer)
+                     .getSubsetChannelBlock(0, (size_t) juce::jmin(buffer.getNumChannels(), getMainBusNumOutputChannels()));
+
+    //(23) the analyzer taps are plain copies into lock-free FIFOs, and do
+    //nothing at all while no editor is open
+    //(25) the dynamic peak listens to the sidechain when asked to and when the
+    //host feeds one, otherwise to the unfiltered main input
+    juce::dsp::AudioBlock<const float> key(block);
+
+    if (dynamicSidechainParameter->load() > 0.5f && getBusCount(true) > 1) {
+        if (auto* sidechain = getBus(true, 1); sidechain != nullptr && sidechain->isEnabled()) {
+            const auto firstChannel = sidechain->getChannelIndexInProcessBlockBuffer(0);
+            const auto numChannels = juce::jmin(sidechain->getNumberOfChannels(), buffer.getNumChannels() - firstChannel);
+
+            if (numChannels > 0)
+                key = juce::dsp::AudioBlock<float>(buffer).getSubsetChannelBlock((size_t) firstChannel, (size_t) numChannels);
+        }
+    }
+
+    {
+        SIMPLEEQ_PROFILE_STAGE(profiler, Analyzer);
+        preEqFifo.push(block);
+    }
+
+    processMainBus(block, key);
+
+    {
+        SIMPLEEQ_PROFILE_STAGE(profiler, Analyzer);
+        postEqFifo.push(block);
+    }
+}
+
+//(29) JUCE's oversampling and convolution only come in float, so a double
+//buffer is converted at the edges, in chunks of the prepared block size, and
+//runs through the float processBlock. The converted samples are exact to
+//float precision; the noise at low cutoffs came from the recursive state,
+//which the double-precision cut stages take care of.
+void SimpleEQ1AudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    const auto numChannels = juce::jmin(buffer.getNumChannels(), (int) conversionChannels.size());
+    const auto chunkSize = juce::jmax(1, conversionBlockSize);
+
+    for (int start = 0; start < buffer.getNumSamples(); start += chunkSize) {
+        const auto length = juce::jmin(chunkSize, buffer.getNumSamples() - start);
+
+        //(32) a view onto the arena's conversion channels, nothing is allocated
+        juce::AudioBuffer<float> conversionBuffer(conversionChannels.data(), (int) conversionChannels.size(), length);
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+            auto* source = buffer.getReadPointer(channel, start);
+            auto* destination = conversionBuffer.getWritePointer(channel);
+
+            for (int i = 0; i < length; ++i)
+                destination[i] = static_cast<float>(source[i]);
+        }
+
+        processBlock(conversionBuffer, midiMessages);
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+            auto* source = conversionBuffer.getReadPointer(channel);
+            auto* destination = buffer.getWritePointer(channel, start);
+
+            for (int i = 0; i < length; ++i)
+                destination[i] = static_cast<double>(source[i]);
+        }
+    }
+}
+
+void SimpleEQ1AudioProcessor::processMainBus(juce::dsp::AudioBlock<float>& block, const juce::dsp::AudioBlock<const float>& key)
+{
+    //(16) reading the raw parameter values is just a handful of atomic loads
+    const auto channelSettings = getChannelSettings();
+    const auto jumpToSettings = jumpToRestoredSettings.exchange(false);
+
+    for (size_t set = 0; set < smoothedSettings.size(); ++set) {
+        smoothedSettings[set].setTargets(channelSettings[set]);
+
+        //(22) a restored state is applied as a jump, not as a sweep from the old settings
+        if (jumpToSettings)
+            smoothedSettings[set].jumpTo(channelSettings[set]);
+    }
+
+    //(28) once the input has been silent for longer than the tail, whatever
+    //was left in the filters has died away and the output is silent too
+    if (processSilence(block))
+        return;
+
+    //(20) linear-phase mode replaces the IIR cascade with the FIR convolution.
+    //The IIR side still follows the parameters so switching back is seamless,
+    //and whichever engine takes over starts from a clean state.
+    if (isLinearPhaseEnabled() && linearPhaseEngine.hasKernel()) {
+        if (!linearPhaseWasActive) {
+            linearPhaseEngine.reset();
+            linearPhaseWasActive = true;
+        }
+
+        //(20) a bounce (or the batch renderer) can wait for the kernel, so the
+        //output doesn't depend on when the background loader ran
+        if (isNonRealtime()) {
+            const juce::ScopedLock lock(designLock);
+            linearPhaseEngine.installLoadedKernel();
+        }
+
+        for (auto& smoothed : smoothedSettings)
+            smoothed.skip((int) block.getNumSamples());
+
+        applyPendingCoefficients();
+
+        //(27) the kernels are per channel, so M/S needs the matrix around them
+        SIMPLEEQ_PROFILE_STAGE(profiler, LinearPhase);
+        linearPhaseEngine.process(block, getNumChannelSets(activeChannelMode) > 1 && activeChannelMode == Channels_MidSide);
+        return;
+    }
+
+    if (linearPhaseWasActive) {
+        resetChains();
+
+        linearPhaseWasActive = false;
+    }
+
+    //(16) the stages that are ramping are redesigned by processFilters, so
+    //only those hold on to their published coefficients until the ramp ends
+    applyPendingCoefficients(getRampingStages(), getRampingBands());
+
+    //(21) oversampling only wraps the IIR cascade, and costs nothing when off
+    if (activeOversampling > 0) {
+        auto& oversampler = *oversamplers[(size_t) activeOversampling];
+        juce::dsp::AudioBlock<float> oversampledBlock;
+
+        {
+            SIMPLEEQ_PROFILE_STAGE(profiler, Oversampling);
+            oversampledBlock = oversampler.processSamplesUp(block);
+        }
+
+        processFilters(oversampledBlock, (int) oversampler.getOversamplingFactor(), key);
+
+        SIMPLEEQ_PROFILE_STAGE(profiler, Oversampling);
+        oversampler.processSamplesDown(block);
+        return;
+    }
+
+    processFilters(block, 1, key);
+}
+
+void SimpleEQ1AudioProcessor::processFilters(juce::dsp::AudioBlock<float>& block, int oversamplingFactor,
+                                             const juce::dsp::AudioBlock<const float>& key)
+{
+    const auto dynamicActive = isDynamicEnabled();
+
+    //(33) the meters run at the processing rate (which already includes the
+    //oversampling), like the filters they follow
+    autoGain.setSampleRate(processingSampleRate);
+    autoGain.setEnabled(isAutoGainEnabled());
+
+    //(27) the second channel set only ramps while it's in use
+    const auto numSets = getNumChannelSets(activeChannelMode);
+    rampCoefficients.setsMatch = numSets == 1;
+
+    //(25) leaving dynamic mode: put the static peak back
+    if (dynamicWasActive && !dynamicActive) {
+        ChannelSettings current;
+
+        for (int set = 0; set < numSets; ++set)
+            current[(size_t) set] = smoothedSettings[(size_t) set].skip(0);
+
+        designStage(Peak, current, numSets, processingSampleRate, rampCoefficients);
+        applyStage(Peak, rampCoefficients);
+    }
+
+    if (dynamicActive && !dynamicWasActive)
+        dynamicPeak.reset();
+
+    dynamicWasActive = dynamicActive;
+
+    if (dynamicActive)
+        dynamicPeak.setParameters(getDynamicParameters());
+
+    if (!isRamping() && !dynamicActive) {
+        processChains(block);
+        return;
+    }
+
+    //(16) something is ramping: redesign only the moving stages, once per stride.
+    //(21) the ramps advance at the host rate, the designs are for the processing rate
+    const auto stride = smoothingStride.load() * oversamplingFactor;
+    const auto numSamples = (int) block.getNumSamples();
+    ChannelSettings current;
+
+    for (int start = 0; start < numSamples; start += stride) {
+        const auto length = juce::jmin(stride, numSamples - start);
+
+        //(31) everything up to the filtering itself counts as ramp cost
+        {
+            SIMPLEEQ_PROFILE_STAGE(profiler, Ramps);
+
+            //(27) a stage is redesigned for both sets if it moves in either of them
+            auto peakMoving = false, lowCutMoving = false, highCutMoving = false;
+            const auto movingBands = smoothedSettings[0].getSmoothingBands();
+
+            for (int set = 0; set < numSets; ++set) {
+                auto& smoothed = smoothedSettings[(size_t) set];
+
+                peakMoving = peakMoving || smoothed.isPeakSmoothing();
+                lowCutMoving = lowCutMoving || smoothed.isLowCutSmoothing();
+                highCutMoving = highCutMoving || smoothed.isHighCutSmoothing();
 
-    //(5) create an audio block to wrap the buffer + extract channels + create ptocessing context
-    juce::dsp::AudioBlock<float> block(buffer);
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+                current[(size_t) set] = smoothed.skip(length / oversamplingFactor);
+            }
 
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+            //(25) in dynamic mode the peak follows the envelope of the key: only
+            //the gain changes between strides, so it's a closed-form update
+            if (dynamicActive) {
+                auto keyBlock = key.getSubBlock((size_t) (start / oversamplingFactor), (size_t) (length / oversamplingFactor));
+                auto amount = dynamicPeak.process(keyBlock, current[0].peakFreq, current[0].peakQuality);
 
-    //pass the contexts to the mono-chains of the filters
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+                for (int set = 0; set < numSets; ++set) {
+                    const auto& settings = current[(size_t) set];
+                    auto gain = DynamicPeak::getGainInDecibels(amount, settings.peakGainInDecibels);
+
+                    rampCoefficients.sets[(size_t) set].peak
+                        = dynamicPeak.designPeak(set, processingSampleRate, settings.peakFreq, settings.peakQuality, gain);
+                }
+
+                applyStage(Peak, rampCoefficients);
+            }
+            else if (peakMoving) {
+                designStage(Peak, current, numSets, processingSampleRate, rampCoefficients);
+                applyStage(Peak, rampCoefficients);
+            }
+
+            if (lowCutMoving) {
+                designStage(LowCut, current, numSets, processingSampleRate, rampCoefficients);
+                applyStage(LowCut, rampCoefficients);
+            }
+
+            if (highCutMoving) {
+                designStage(HighCut, current, numSets, processingSampleRate, rampCoefficients);
+                applyStage(HighCut, rampCoefficients);
+            }
+
+            //(26) only the bands that are actually moving
+            //(27) the bands are shared by both channel sets
+            auto& bands = rampCoefficients.sets[0].bands;
+
+            for (int band = 0; movingBands >> band != 0; ++band) {
+                if ((movingBands & (1u << band)) == 0)
+                    continue;
+
+                bands[(size_t) band] = designBand(current[0], band, processingSampleRate);
+                SIMPLEEQ_PROFILE_COEFFICIENT_UPDATE(profiler);
+
+                for (auto& chain : simdChains)
+                    chain.setSection(BandSlot + band, bands[(size_t) band]);
+            }
+        }
+
+        auto subBlock = block.getSubBlock((size_t) start, (size_t) length);
+        processChains(subBlock);
+    }
+}
+
+bool SimpleEQ1AudioProcessor::isRamping() const
+{
+    if (smoothedSettings[0].isSmoothing())
+        return true;
+
+    return getNumChannelSets(activeChannelMode) > 1 && smoothedSettings[1].isSmoothing();
+}
+
+juce::uint32 SimpleEQ1AudioProcessor::getRampingStages() const
+{
+    juce::uint32 stages = 0;
+
+    for (int set = 0; set < getNumChannelSets(activeChannelMode); ++set) {
+        const auto& smoothed = smoothedSettings[(size_t) set];
+
+        if (smoothed.isLowCutSmoothing())
+            stages |= 1u << LowCut;
+
+        if (smoothed.isPeakSmoothing())
+            stages |= 1u << Peak;
+
+        if (smoothed.isHighCutSmoothing())
+            stages |= 1u << HighCut;
+    }
+
+    return stages;
+}
+
+//(5) extract channels + create processing context
+//(17) the channels are interleaved into the lanes of SIMDFloat frames, so one
+//pass through a chain filters SIMDFloat::size() of them
+//(18) one group of lanes per chain, all sharing the same scratch space
+void SimpleEQ1AudioProcessor::processChains(juce::dsp::AudioBlock<float>& block)
+{
+    SIMPLEEQ_PROFILE_STAGE(profiler, Filters);
+
+    constexpr auto numLanes = SIMDFloat::size();
+    const auto numChannels = juce::jmin(block.getNumChannels(), simdChains.size() * numLanes);
+    const auto numSamples = block.getNumSamples();
+    const auto capacity = interleaved.size();
+    auto* frames = reinterpret_cast<float*>(interleaved.data());
+
+    jassert(block.getNumChannels() <= simdChains.size() * numLanes);
+
+    //(27) the Mid/Side matrix is applied while interleaving and deinterleaving,
+    //so it doesn't cost an extra pass over the buffer
+    const auto midSide = getNumChannelSets(activeChannelMode) > 1 && activeChannelMode == Channels_MidSide
+                         && numChannels == 2;
+
+    //(33) every group follows the same gain ramp over the block. The meters
+    //see Mid/Side frames in that mode, on both sides, so the ratio holds.
+    const auto autoGainActive = autoGain.isActive() && numSamples > 0;
+
+    if (autoGainActive)
+        autoGain.beginBlock(numSamples);
+
+    for (size_t firstChannel = 0, group = 0; firstChannel < numChannels; firstChannel += numLanes, ++group) {
+        const auto numInGroup = juce::jmin(numLanes, numChannels - firstChannel);
+
+        for (size_t start = 0; start < numSamples; start += capacity) {
+            const auto length = juce::jmin(capacity, numSamples - start);
+
+            if (midSide) {
+                auto* left = block.getChannelPointer(0) + start;
+                auto* right = block.getChannelPointer(1) + start;
+
+                for (size_t i = 0; i < length; ++i) {
+                    frames[i * numLanes] = 0.5f * (left[i] + right[i]);
+                    frames[i * numLanes + 1] = 0.5f * (left[i] - right[i]);
+                }
+            }
+            else {
+                for (size_t lane = 0; lane < numInGroup; ++lane) {
+                    auto* source = block.getChannelPointer(firstChannel + lane) + start;
+
+                    for (size_t i = 0; i < length; ++i)
+                        frames[i * numLanes + lane] = source[i];
+                }
+            }
+
+            //lanes without a channel are kept silent
+            for (size_t lane = numInGroup; lane < numLanes; ++lane)
+                for (size_t i = 0; i < length; ++i)
+                    frames[i * numLanes + lane] = 0.f;
+
+            //(33) the input meter, while the frames are fresh in the cache
+            if (autoGainActive)
+                autoGain.measureInput(autoGainStates[group].input, interleaved.data(), length);
+
+            //(29) the double-precision cuts run lane by lane on the interleaved
+            //frames, in the same place in the cascade as the float sections would
+            if (lowCutInDouble)
+                for (size_t lane = 0; lane < numInGroup; ++lane)
+                    getPreciseCut(group, lane, true).process<numLanes>(frames + lane, length);
+
+            simdChains[group].process(interleaved.data(), length);
+
+            if (highCutInDouble)
+                for (size_t lane = 0; lane < numInGroup; ++lane)
+                    getPreciseCut(group, lane, false).process<numLanes>(frames + lane, length);
+
+            //(33) after the high cut: the output meter and the make-up gain, in one pass
+            if (autoGainActive)
+                autoGain.processOutput(autoGainStates[group].output, interleaved.data(), start, length);
+
+            if (midSide) {
+                auto* left = block.getChannelPointer(0) + start;
+                auto* right = block.getChannelPointer(1) + start;
+
+                for (size_t i = 0; i < length; ++i) {
+                    left[i] = frames[i * numLanes] + frames[i * numLanes + 1];
+                    right[i] = frames[i * numLanes] - frames[i * numLanes + 1];
+                }
+
+                continue;
+            }
+
+            for (size_t lane = 0; lane < numInGroup; ++lane) {
+                auto* destination = block.getChannelPointer(firstChannel + lane) + start;
+
+                for (size_t i = 0; i < length; ++i)
+                    destination[i] = frames[i * numLanes + lane];
+            }
+        }
+    }
+
+    if (autoGainActive)
+        autoGain.endBlock(numSamples);
 }
 
 //==============================================================================
@@ -181,96 +738,895 @@ bool SimpleEQ1AudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor* SimpleEQ1AudioProcessor::createEditor()
 {
-    //return new SimpleEQ1AudioProcessorEditor (*this);
-    //(2)
-    return new juce::GenericAudioProcessorEditor(*this);
+    //(2) the generic editor...
+    //(23) ...now lives inside our own editor, under the spectrum analyzer
+    return new SimpleEQ1AudioProcessorEditor (*this);
 }
 
 //==============================================================================
 void SimpleEQ1AudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    //(22) the XML fallback, when the binary state couldn't be read back
+    if (!binaryStateIsUnambiguous) {
+        if (auto xml = apvts.copyState().createXml())
+            copyXmlToBinary(*xml, destData);
+
+        return;
+    }
+
+    //(22) 8 bytes of header + 8 bytes per parameter, written straight from the parameters
+    juce::MemoryOutputStream stream(destData, false);
+
+    stream.writeInt(stateMagic);
+    stream.writeShort((short) stateVersion);
+    stream.writeShort((short) stateParameters.size());
+
+    for (auto* param : stateParameters) {
+        stream.writeInt(param->paramID.hashCode());
+        stream.writeFloat(param->getValue());
+    }
 }
 
 void SimpleEQ1AudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    //(22) the design thread waits until every parameter is restored, so the
+    //whole chain is redesigned once instead of once per parameter
+    const juce::ScopedLock lock(designLock);
+
+    juce::MemoryInputStream stream(data, (size_t) sizeInBytes, false);
+
+    if (sizeInBytes >= 8 && stream.readInt() == stateMagic) {
+        //(22) a layout from a newer version can't be read: keep the current settings
+        if (!restoreBinaryState(stream))
+            return;
+    }
+    else if (auto xml = getXmlFromBinary(data, sizeInBytes)) {
+        //XML fallback, as written by apvts.copyState()
+        if (xml->hasTagName(apvts.state.getType()))
+            apvts.replaceState(juce::ValueTree::fromXml(*xml));
+    }
+
+    jumpToRestoredSettings.store(true);
+}
+
+//(22) parameters missing from the state go back to their defaults, unknown
+//entries (e.g. parameters added by a later version) are skipped. Returns false,
+//without touching anything, for a version whose layout isn't known.
+bool SimpleEQ1AudioProcessor::restoreBinaryState(juce::MemoryInputStream& stream) {
+    const auto version = (int) (juce::uint16) stream.readShort();
+    const auto numEntries = (int) (juce::uint16) stream.readShort();
+
+    if (version < 1 || version > stateVersion)
+        return false;
+
+    std::vector<bool> restored(stateParameters.size(), false);
+
+    for (int i = 0; i < numEntries && stream.getNumBytesRemaining() >= 8; ++i) {
+        const auto hash = stream.readInt();
+        const auto value = juce::jlimit(0.f, 1.f, stream.readFloat());
+
+        auto found = stateParameterIndexByHash.find(hash);
+
+        if (found == stateParameterIndexByHash.end() || found->second == ambiguousStateEntry)
+            continue;
+
+        auto* param = stateParameters[found->second];
+
+        if (param->getValue() != value)
+            param->setValueNotifyingHost(value);
+
+        restored[found->second] = true;
+    }
+
+    for (size_t i = 0; i < stateParameters.size(); ++i)
+        if (!restored[i] && stateParameters[i]->getValue() != stateParameters[i]->getDefaultValue())
+            stateParameters[i]->setValueNotifyingHost(stateParameters[i]->getDefaultValue());
+
+    return true;
 }
 
 
 //(6) define the helper function that gives us the parameters from the chain
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts) {
+//(26)
+juce::String getBandParameterID(int band, const juce::String& name) {
+    return "Band" + juce::String(band + 1) + " " + name;
+}
+
+//(27)
+juce::String getChannelParameterID(const juce::String& parameterID, int channelSet) {
+    return channelSet == 0 ? parameterID : parameterID + " " + juce::String(channelSet + 1);
+}
+
+ChainParameters::ChainParameters(juce::AudioProcessorValueTreeState& apvts) {
+    for (int set = 0; set < ChannelCoefficients::numSets; ++set) {
+        auto get = [&](const char* parameterID) { return apvts.getRawParameterValue(getChannelParameterID(parameterID, set)); };
+        auto& pointers = channels[(size_t) set];
+
+        pointers.lowCutFreq = get("LowCut Freq");
+        pointers.highCutFreq = get("HighCut Freq");
+        pointers.lowCutSlope = get("LowCut Slope");
+        pointers.highCutSlope = get("HighCut Slope");
+        pointers.peakFreq = get("Peak Freq");
+        pointers.peakGain = get("Peak Gain");
+        pointers.peakQuality = get("Peak Quality");
+    }
+
+    for (int band = 0; band < BandSettings::maxBands; ++band) {
+        auto& pointers = bands[(size_t) band];
+        pointers.enabled = apvts.getRawParameterValue(getBandParameterID(band, "On"));
+        pointers.type = apvts.getRawParameterValue(getBandParameterID(band, "Type"));
+        pointers.freq = apvts.getRawParameterValue(getBandParameterID(band, "Freq"));
+        pointers.gain = apvts.getRawParameterValue(getBandParameterID(band, "Gain"));
+        pointers.quality = apvts.getRawParameterValue(getBandParameterID(band, "Quality"));
+    }
+}
+
+ChainSettings getChainSettings(const ChainParameters& parameters, int channelSet) {
     ChainSettings settings;
+    const auto& channel = parameters.channels[(size_t) channelSet];
+
+    settings.lowCutFreq = channel.lowCutFreq->load();
+    settings.highCutFreq = channel.highCutFreq->load();
+    settings.peakFreq = channel.peakFreq->load();
+    settings.peakGainInDecibels = channel.peakGain->load();
+    settings.peakQuality = channel.peakQuality->load();
+    settings.lowCutSlope = static_cast<Slope>(channel.lowCutSlope->load());
+    settings.highCutSlope = static_cast<Slope>(channel.highCutSlope->load());
+
+    for (size_t band = 0; band < (size_t) BandSettings::maxBands; ++band) {
+        auto& pointers = parameters.bands[band];
+        settings.bands.enabled[band] = pointers.enabled->load() > 0.5f;
+        settings.bands.type[band] = static_cast<BandType>(pointers.type->load());
+        settings.bands.freq[band] = pointers.freq->load();
+        settings.bands.gainInDecibels[band] = pointers.gain->load();
+        settings.bands.quality[band] = pointers.quality->load();
+    }
 
-    settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load();
-    settings.highCutFreq = apvts.getRawParameterValue("HighCut Freq")->load();
-    settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
-    settings.peakGainInDecibels = apvts.getRawParameterValue("Peak Gain")->load();
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
     return settings;
 }
 
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts) {
+    return getChainSettings(ChainParameters(apvts));
+}
+
+SimpleEQ1AudioProcessor::ChannelSettings SimpleEQ1AudioProcessor::getChannelSettings() const {
+    ChannelSettings settings;
+
+    for (int set = 0; set < ChannelCoefficients::numSets; ++set)
+        settings[(size_t) set] = getChainSettings(chainParameters, set);
+
+    return settings;
+}
+
+//(25)
+DynamicPeak::Parameters SimpleEQ1AudioProcessor::getDynamicParameters() const {
+    DynamicPeak::Parameters parameters;
+
+    parameters.thresholdInDecibels = dynamicThresholdParameter->load();
+    parameters.ratio = dynamicRatioParameter->load();
+    parameters.attackMs = dynamicAttackParameter->load();
+    parameters.releaseMs = dynamicReleaseParameter->load();
+    return parameters;
+}
+
+bool SimpleEQ1AudioProcessor::processesChannelsIndependently() const {
+    return getChannelMode() == Channels_Stereo && !isDynamicEnabled() && !isAutoGainEnabled();
+}
+
+double SimpleEQ1AudioProcessor::getSettlingTimeSeconds() const {
+    //every one of them is a one-pole smoother, which gets within -60 dB of
+    //where it's heading after ln(1000) time constants
+    const auto timeConstants = std::log(1000.0);
+    auto seconds = 0.0;
+
+    if (isDynamicEnabled()) {
+        const auto parameters = getDynamicParameters();
+        seconds += timeConstants * (parameters.attackMs + parameters.releaseMs) * 0.001;
+    }
+
+    //the meters listen to the dynamic peak's output, so the two add up
+    if (isAutoGainEnabled())
+        seconds += timeConstants * (AutoGain::integrationSeconds + AutoGain::gainSmoothingSeconds);
+
+    return seconds;
+}
+
 //(10) refactoring, update peak
-void SimpleEQ1AudioProcessor::updatePeakFilter(const ChainSettings& chainSettings) {
+void SimpleEQ1AudioProcessor::updatePeakFilter(const ChannelSettings& chainSettings) {
+    updateStage(Peak, chainSettings);
+}
 
-    auto peakCoefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(
-        getSampleRate(),
+//(26) the extra bands
+BiquadCoefficients SimpleEQ1AudioProcessor::designBand(const ChainSettings& chainSettings, int band, double sampleRate) {
+    const auto& bands = chainSettings.bands;
+    const auto frequency = juce::jmin((double) bands.freq[(size_t) band], sampleRate * 0.49);
+    const auto quality = (double) bands.quality[(size_t) band];
+    const auto gainFactor = (double) juce::Decibels::decibelsToGain(bands.gainInDecibels[(size_t) band]);
+
+    switch (bands.type[(size_t) band]) {
+        case Band_LowShelf:  return BiquadDesign::makeShelf(false, sampleRate, frequency, quality, gainFactor);
+        case Band_HighShelf: return BiquadDesign::makeShelf(true, sampleRate, frequency, quality, gainFactor);
+        case Band_Notch:     return BiquadDesign::makeNotch(sampleRate, frequency, quality);
+        case Band_BandPass:  return BiquadDesign::makeBandPass(sampleRate, frequency, quality);
+        case Band_Peak:
+        default:             return BiquadDesign::makePeak(sampleRate, frequency, quality, gainFactor);
+    }
+}
+
+void SimpleEQ1AudioProcessor::designBands(const ChainSettings& chainSettings, double sampleRate, CoefficientSet& destination) {
+    destination.activeBands = 0;
+
+    for (int band = 0; band < BandSettings::maxBands; ++band) {
+        if (!chainSettings.bands.enabled[(size_t) band])
+            continue;
+
+        destination.bands[(size_t) band] = designBand(chainSettings, band, sampleRate);
+        destination.activeBands |= 1u << band;
+    }
+}
+
+void SimpleEQ1AudioProcessor::updateBands(const ChannelSettings& chainSettings) {
+    updateStage(Bands, chainSettings);
+}
+
+//(27) design one stage for the channel sets in use. The second set reuses the
+//first set's coefficients when its settings for the stage are the same, and
+//the bands are shared anyway.
+void SimpleEQ1AudioProcessor::designStage(int chainPosition, const ChannelSettings& chainSettings, int numSets,
+                                          double sampleRate, ChannelCoefficients& destination, ButterworthCache* cache) {
+    for (int set = 0; set < numSets; ++set) {
+        auto& coefficients = destination.sets[(size_t) set];
+
+        if (set > 0 && (chainPosition == Bands || isStageShared(chainPosition, chainSettings[0], chainSettings[(size_t) set]))) {
+            copyStage(chainPosition, destination.sets[0], coefficients);
+            continue;
+        }
+
+        switch (chainPosition) {
+            case Peak:    designPeakFilter(chainSettings[(size_t) set], sampleRate, coefficients); break;
+            case LowCut:  designLowCutFilter(chainSettings[(size_t) set], sampleRate, coefficients, cache); break;
+            case HighCut: designHighCutFilter(chainSettings[(size_t) set], sampleRate, coefficients, cache); break;
+            case Bands:   designBands(chainSettings[(size_t) set], sampleRate, coefficients); break;
+            default:      break;
+        }
+    }
+}
+
+void SimpleEQ1AudioProcessor::updateStage(int chainPosition, const ChannelSettings& chainSettings) {
+    const auto numSets = getNumChannelSets(designedCoefficients.channelMode);
+
+    designStage(chainPosition, chainSettings, numSets, designedCoefficients.sets[0].sampleRate, designedCoefficients,
+                butterworthCache.get());
+
+    for (auto& coefficients : designedCoefficients.sets)
+        ++coefficients.generations[(size_t) chainPosition];
+}
+
+bool SimpleEQ1AudioProcessor::isStageShared(int chainPosition, const ChainSettings& first, const ChainSettings& second) {
+    switch (chainPosition) {
+        case Peak:
+            return first.peakFreq == second.peakFreq && first.peakQuality == second.peakQuality
+                && first.peakGainInDecibels == second.peakGainInDecibels;
+        case LowCut:
+            return first.lowCutFreq == second.lowCutFreq && first.lowCutSlope == second.lowCutSlope;
+        case HighCut:
+            return first.highCutFreq == second.highCutFreq && first.highCutSlope == second.highCutSlope;
+        default:
+            return true;
+    }
+}
+
+void SimpleEQ1AudioProcessor::copyStage(int chainPosition, const CoefficientSet& source, CoefficientSet& destination) {
+    switch (chainPosition) {
+        case Peak:
+            destination.peak = source.peak;
+            break;
+        case LowCut:
+            destination.lowCut = source.lowCut;
+            destination.lowCutSlope = source.lowCutSlope;
+            destination.lowCutInDouble = source.lowCutInDouble;
+            break;
+        case HighCut:
+            destination.highCut = source.highCut;
+            destination.highCutSlope = source.highCutSlope;
+            destination.highCutInDouble = source.highCutInDouble;
+            break;
+        case Bands:
+            destination.bands = source.bands;
+            destination.activeBands = source.activeBands;
+            break;
+        default:
+            break;
+    }
+}
+
+//(13) refactoring, function that updates all filters at once (+her helpers)
+
+void SimpleEQ1AudioProcessor::updateLowCutFilters(const ChannelSettings& chainSettings) {
+    updateStage(LowCut, chainSettings);
+}
+
+void SimpleEQ1AudioProcessor::updateHighCutFilters(const ChannelSettings& chainSettings) {
+    updateStage(HighCut, chainSettings);
+}
+
+//(16) closed-form designs, identical to makePeakFilter and
+//designIIR*HighOrderButterworthMethod but without any allocation
+void SimpleEQ1AudioProcessor::designPeakFilter(const ChainSettings& chainSettings, double sampleRate, CoefficientSet& destination) {
+    destination.peak = BiquadDesign::makePeak(
+        sampleRate,
         chainSettings.peakFreq,
         chainSettings.peakQuality,
         juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels)
     );
+}
+
+void SimpleEQ1AudioProcessor::designLowCutFilter(const ChainSettings& chainSettings, double sampleRate, CoefficientSet& destination,
+                                                 ButterworthCache* cache) {
+    if (cache != nullptr)
+        cache->design(true, sampleRate, chainSettings.lowCutFreq, chainSettings.lowCutSlope + 1, destination.lowCut);
+    else
+        BiquadDesign::makeButterworthCascade(
+            true,
+            sampleRate,
+            chainSettings.lowCutFreq,
+            chainSettings.lowCutSlope + 1, //one biquad per 12 dB/Oct
+            destination.lowCut
+        );
 
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients,
-        peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients,
-        peakCoefficients);
+    destination.lowCutSlope = chainSettings.lowCutSlope;
+    destination.lowCutInDouble = needsDoublePrecision(chainSettings.lowCutFreq, sampleRate);
 }
 
-//(10) refactoring, update peak filter coeff
-void SimpleEQ1AudioProcessor::updateCoefficients(Coefficients& old, const Coefficients& replacements) {
-    *old = *replacements;
+void SimpleEQ1AudioProcessor::designHighCutFilter(const ChainSettings& chainSettings, double sampleRate, CoefficientSet& destination,
+                                                 ButterworthCache* cache) {
+    if (cache != nullptr)
+        cache->design(false, sampleRate, chainSettings.highCutFreq, chainSettings.highCutSlope + 1, destination.highCut);
+    else
+        BiquadDesign::makeButterworthCascade(
+            false,
+            sampleRate,
+            chainSettings.highCutFreq,
+            chainSettings.highCutSlope + 1, //one biquad per 12 dB/Oct
+            destination.highCut
+        );
+
+    destination.highCutSlope = chainSettings.highCutSlope;
+    destination.highCutInDouble = needsDoublePrecision(chainSettings.highCutFreq, sampleRate);
 }
 
-//(13) refactoring, function that updates all filters at once (+her helpers)
+bool SimpleEQ1AudioProcessor::updateFilters() {
+    //(14) nothing moved since the last block: keep the current coefficients
+    if (std::none_of(std::begin(stageDirty), std::end(stageDirty), [](auto& flag) { return flag.load(); }))
+        return false;
 
-void SimpleEQ1AudioProcessor::updateLowCutFilters(const ChainSettings& chainSettings) {
-    auto cutCoefficients = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(
-        chainSettings.lowCutFreq,
-        getSampleRate(),
-        (chainSettings.lowCutSlope + 1) * 2 //setting the order parameter
-    );
+    //(15) not prepared yet, keep the flags raised until we know the sample rate
+    if (designSampleRate.load() <= 0.0)
+        return false;
 
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
-    updateCutFilter(leftLowCut, cutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(rightLowCut, cutCoefficients, chainSettings.lowCutSlope);
+    //(31) always under designLock, so the design records have one writer at a time
+    SIMPLEEQ_PROFILE_DESIGN(profiler);
+
+    //(14) the flags are cleared before the parameters are read: a change that
+    //lands in between raises its flag again and gets designed next time round,
+    //instead of being cleared without ever having been seen
+    const auto peakDirty = stageDirty[Peak].exchange(false);
+    const auto lowCutDirty = stageDirty[LowCut].exchange(false);
+    const auto highCutDirty = stageDirty[HighCut].exchange(false);
+    const auto bandsDirty = stageDirty[Bands].exchange(false);
+
+    //(21) the filters run at the oversampled rate
+    for (auto& coefficients : designedCoefficients.sets) {
+        coefficients.oversamplingIndex = getOversamplingIndex();
+        coefficients.sampleRate = designSampleRate.load() * (1 << coefficients.oversamplingIndex);
+    }
+
+    //(27) a channel mode change marks every stage dirty, so both sets are complete
+    designedCoefficients.channelMode = getChannelMode();
+
+    //first get hold of the chain settings
+    auto chainSettings = getChannelSettings();
+
+    //now you can call teh helpers, but only for the stages that changed
+    if (peakDirty)
+        updatePeakFilter(chainSettings);
+
+    if (lowCutDirty)
+        updateLowCutFilters(chainSettings);
+
+    if (highCutDirty)
+        updateHighCutFilters(chainSettings);
+
+    if (bandsDirty)
+        updateBands(chainSettings);
+
+    //(27) identical sets let the audio thread skip the per-lane updates
+    designedCoefficients.setsMatch = getNumChannelSets(designedCoefficients.channelMode) == 1
+        || (isStageShared(Peak, chainSettings[0], chainSettings[1])
+            && isStageShared(LowCut, chainSettings[0], chainSettings[1])
+            && isStageShared(HighCut, chainSettings[0], chainSettings[1]));
+
+    //(15) hand the complete set over to the audio thread
+    coefficientMailbox.getWriteBuffer() = designedCoefficients;
+    coefficientMailbox.publish();
+
+    //(20) the linear-phase kernel follows the new coefficients
+    kernelDirty.store(true);
+    return true;
 }
 
-void SimpleEQ1AudioProcessor::updateHighCutFilters(const ChainSettings& chainSettings) {
-    auto cutCoefficients = juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(
-        chainSettings.highCutFreq,
-        getSampleRate(),
-        (chainSettings.highCutSlope + 1) * 2 //setting the order parameter
-    );
+bool SimpleEQ1AudioProcessor::getCoefficientsForDisplay(ChannelCoefficients& destination)
+{
+    const juce::ScopedTryLock lock(designLock);
 
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
-    updateCutFilter(leftHighCut, cutCoefficients, chainSettings.highCutSlope);
-    updateCutFilter(rightHighCut, cutCoefficients, chainSettings.highCutSlope);
+    if (!lock.isLocked())
+        return false;
+
+    destination = designedCoefficients;
+    return true;
 }
 
-void SimpleEQ1AudioProcessor::updateFilters() {
-    //first get hold of the chain settings
-    auto chainSettings = getChainSettings(apvts);
-    updatePeakFilter(chainSettings);
+//(21) keeps the reported latency in sync with the processing mode (holding designLock)
+void SimpleEQ1AudioProcessor::updateLatency() {
+    auto latency = 0;
+
+    //(20) until its first kernel is loaded the audio keeps taking the IIR path,
+    //so that's the latency to report; this runs again once the kernel is in
+    latencyIsForLinearPhase = isLinearPhaseActive();
+
+    if (latencyIsForLinearPhase)
+        latency = linearPhaseEngine.getLatencyInSamples();
+    else if (auto& oversampler = oversamplers[(size_t) designedCoefficients.sets[0].oversamplingIndex])
+        latency = juce::roundToInt(oversampler->getLatencyInSamples());
+
+    if (getLatencySamples() != latency)
+        setLatencySamples(latency);
+}
+
+//(28) the tail reported to the host, and the silence the input needs before
+//processing stops (holding designLock)
+void SimpleEQ1AudioProcessor::updateTailLength() {
+    const auto sampleRate = designSampleRate.load();
+
+    if (sampleRate <= 0.0)
+        return;
+
+    //the FIR kernel is twice its latency long
+    if (isLinearPhaseActive()) {
+        tailLengthSeconds.store(2.0 * linearPhaseEngine.getLatencyInSamples() / sampleRate);
+        return;
+    }
+
+    const auto numSets = getNumChannelSets(designedCoefficients.channelMode);
+    auto seconds = 0.0;
+
+    for (int set = 0; set < numSets; ++set) {
+        const auto& coefficients = designedCoefficients.sets[(size_t) set];
+
+        if (coefficients.sampleRate > 0.0)
+            seconds = juce::jmax(seconds, coefficients.getTailLengthInSamples(-silenceThresholdInDecibels) / coefficients.sampleRate);
+    }
+
+    //(21) plus whatever the oversampling filters hold
+    if (auto& oversampler = oversamplers[(size_t) designedCoefficients.sets[0].oversamplingIndex])
+        seconds += 2.0 * oversampler->getLatencyInSamples() / sampleRate;
+
+    tailLengthSeconds.store(juce::jmin(seconds, maxTailLengthSeconds));
+}
+
+//(28) audio thread: counts silent input and, once the tail has run out,
+//clears the block instead of filtering it. The filter state has decayed
+//below the threshold by then, so zeroing it is inaudible and the filters
+//pick up from a clean state (no click) when the signal comes back.
+bool SimpleEQ1AudioProcessor::processSilence(juce::dsp::AudioBlock<float>& block) {
+    const auto numSamples = (int) block.getNumSamples();
+    const auto threshold = juce::Decibels::decibelsToGain(silenceThresholdInDecibels, -1000.f);
+
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel) {
+        auto range = juce::FloatVectorOperations::findMinAndMax(block.getChannelPointer(channel), numSamples);
+
+        if (range.getStart() < -threshold || range.getEnd() > threshold) {
+            silentSamples = 0;
+            silenceBypassed = false;
+            return false;
+        }
+    }
+
+    const auto tailSamples = (juce::int64) std::ceil(tailLengthSeconds.load() * designSampleRate.load());
+
+    if (silentSamples <= tailSamples) {
+        silentSamples += numSamples;
+        return false;
+    }
+
+    if (!silenceBypassed) {
+        resetChains();
+
+        for (auto& oversampler : oversamplers)
+            if (oversampler != nullptr)
+                oversampler->reset();
+
+        linearPhaseEngine.reset();
+        silenceBypassed = true;
+    }
+
+    //the ramps still follow the parameters, so nothing jumps when processing resumes
+    for (auto& smoothed : smoothedSettings)
+        smoothed.skip(numSamples);
+
+    applyPendingCoefficients();
+
+    block.clear();
+    return true;
+}
+
+//(20) rebuilds the FIR kernel when needed (holding designLock)
+void SimpleEQ1AudioProcessor::updateLinearPhaseKernel() {
+    const auto enabled = isLinearPhaseEnabled();
+
+    if (!enabled || !kernelDirty.load() || designSampleRate.load() <= 0.0)
+        return;
+
+    const auto now = juce::Time::getMillisecondCounter();
+
+    //(20) offline the kernel follows every change, a wall-clock rate limit
+    //would make the render depend on how fast the machine is
+    if (!isNonRealtime() && lastKernelUpdateTime != 0 && now - lastKernelUpdateTime < kernelUpdateIntervalMs)
+        return;
+
+    kernelDirty.store(false);
+    //(27) one kernel per channel set
+    const auto& sets = designedCoefficients.sets;
+    linearPhaseEngine.loadKernel(sets[0], designedCoefficients.setsMatch ? sets[0] : sets[1]);
+    lastKernelUpdateTime = now;
+}
+
+//(15) audio thread side of the handoff: wait-free, no allocations
+//(16) stages in rampingStages (and bands in rampingBands) are left to the
+//ramps; everything else, structural changes included, goes in right away
+void SimpleEQ1AudioProcessor::applyPendingCoefficients(juce::uint32 rampingStages, juce::uint32 rampingBands) {
+    SIMPLEEQ_PROFILE_STAGE(profiler, ApplyCoefficients);
+    auto* pending = coefficientMailbox.acquire();
+
+    //(16) what a ramp held back last time is still in the buffer acquired
+    //then, which stays ours until the next acquire()
+    if (pending == nullptr)
+        pending = heldCoefficients;
+
+    heldCoefficients = nullptr;
+
+    if (pending == nullptr)
+        return;
+
+    const auto& first = pending->sets[0];
+
+    //(21) the oversampling factor changes together with the coefficients
+    //designed for it; the old filter state is meaningless at the new rate
+    if (first.oversamplingIndex != activeOversampling) {
+        activeOversampling = first.oversamplingIndex;
+
+        resetChains();
+
+        if (auto& oversampler = oversamplers[(size_t) activeOversampling])
+            oversampler->reset();
+    }
+
+    processingSampleRate = first.sampleRate;
+
+    //(27) a new channel mode changes what the lanes hold, so the old state
+    //goes and every stage is loaded again; the second set's ramps start out
+    //at its targets rather than sweeping from wherever they were left
+    if (pending->channelMode != activeChannelMode) {
+        activeChannelMode = pending->channelMode;
+
+        resetChains();
 
-    //now you can call teh helpers
-    updateLowCutFilters(chainSettings);
-    updateHighCutFilters(chainSettings);
+        smoothedSettings[1].jumpTo(getChainSettings(chainParameters, 1));
+
+        for (auto position : { LowCut, Peak, HighCut, Bands })
+            applyStage(position, *pending);
+
+        for (size_t set = 0; set < pending->sets.size(); ++set)
+            appliedGenerations[set] = pending->sets[set].generations;
+
+        return;
+    }
+
+    for (auto position : { LowCut, Peak, HighCut, Bands }) {
+        auto changed = false;
+
+        for (size_t set = 0; set < pending->sets.size(); ++set)
+            changed = changed || pending->sets[set].generations[position] != appliedGenerations[set][position];
+
+        if (!changed)
+            continue;
+
+        //(16) a ramping stage keeps what the ramp designs, and the published
+        //one is applied once the ramp has finished
+        const auto ramping = (rampingStages & (1u << position)) != 0;
+        const auto skippedBands = position == Bands ? rampingBands : 0u;
+
+        if (!ramping)
+            applyStage(position, *pending, skippedBands);
+
+        if (ramping || skippedBands != 0) {
+            heldCoefficients = pending;
+            continue;
+        }
+
+        for (size_t set = 0; set < pending->sets.size(); ++set)
+            appliedGenerations[set][position] = pending->sets[set].generations[position];
+    }
+}
+
+//(16) copy one stage of a coefficient set into the chains
+//(27) in the dual modes the first group's lanes 0 and 1 get a set each
+void SimpleEQ1AudioProcessor::applyStage(int chainPosition, const ChannelCoefficients& coefficients,
+                                         juce::uint32 skippedBands) {
+    SIMPLEEQ_PROFILE_COEFFICIENT_UPDATE(profiler);
+
+    const auto perLane = getNumChannelSets(activeChannelMode) > 1 && !coefficients.setsMatch;
+    const auto& first = coefficients.sets[0];
+    const auto& second = coefficients.sets[1];
+
+    //(29) the cut stages may live in the double-precision cascades
+    if (chainPosition == LowCut || chainPosition == HighCut) {
+        applyCutStage(chainPosition == LowCut, coefficients, perLane);
+        return;
+    }
+
+    for (auto& chain : simdChains) {
+        switch (chainPosition) {
+
+        case Peak: {
+            if (perLane) {
+                chain.setSection(PeakSlot, 0, first.peak);
+                chain.setSection(PeakSlot, 1, second.peak);
+            }
+            else {
+                chain.setSection(PeakSlot, first.peak);
+            }
+            break;
+            }
+        case Bands: {
+            //(27) the bands are shared, so they're always broadcast
+            for (int band = 0; band < BandSettings::maxBands; ++band) {
+                if (first.isBandActive(band) && (skippedBands & (1u << band)) == 0)
+                    chain.setSection(BandSlot + band, first.bands[(size_t) band]);
+
+                chain.setSectionActive(BandSlot + band, first.isBandActive(band));
+            }
+            break;
+            }
+        default:
+            break;
+        }
+    }
+}
+
+//(29) loads a cut stage into the float chains or the double-precision
+//cascades. When it moves from one to the other, the filter state moves with
+//it: same coefficients and same structure, so the output carries on as if
+//nothing happened.
+void SimpleEQ1AudioProcessor::applyCutStage(bool isLowCut, const ChannelCoefficients& coefficients, bool perLane) {
+    const auto firstSlot = isLowCut ? LowCutSlot : HighCutSlot;
+    auto& inDouble = isLowCut ? lowCutInDouble : highCutInDouble;
+
+    const auto& first = coefficients.sets[0];
+    const auto& second = perLane ? coefficients.sets[1] : first;
+
+    auto getCut = [isLowCut](const CoefficientSet& set) -> const std::array<BiquadCoefficients, 4>& {
+        return isLowCut ? set.lowCut : set.highCut;
+    };
+    auto getSlope = [isLowCut](const CoefficientSet& set) {
+        return static_cast<Slope>(isLowCut ? set.lowCutSlope : set.highCutSlope);
+    };
+    auto needsDouble = [isLowCut](const CoefficientSet& set) {
+        return isLowCut ? set.lowCutInDouble : set.highCutInDouble;
+    };
+
+    const auto shouldBeInDouble = needsDouble(first) || needsDouble(second);
+    const auto numSections = (int) first.lowCut.size();
+
+    for (size_t group = 0; group < simdChains.size(); ++group) {
+        auto& chain = simdChains[group];
+
+        if (shouldBeInDouble) {
+            for (size_t lane = 0; lane < SIMDFloat::size(); ++lane) {
+                //(27) in the dual modes lane 1 is the second channel
+                const auto& set = lane == 1 ? second : first;
+                const auto slope = getSlope(set);
+                auto& cascade = getPreciseCut(group, lane, isLowCut);
+
+                for (int i = 0; i < numSections; ++i) {
+                    if (i <= slope)
+                        cascade.setSection(i, getCut(set)[(size_t) i]);
+
+                    cascade.setSectionActive(i, i <= slope);
+
+                    if (!inDouble && i <= slope && chain.isSectionActive(firstSlot + i))
+                        cascade.setState(i, 0, chain.getState(firstSlot + i, lane, false),
+                                               chain.getState(firstSlot + i, lane, true));
+                }
+            }
+
+            for (int i = 0; i < numSections; ++i)
+                chain.setSectionActive(firstSlot + i, false);
+
+            continue;
+        }
+
+        if (perLane)
+            updateCutFilter(chain, firstSlot, getCut(first), getSlope(first), getCut(second), getSlope(second));
+        else
+            updateCutFilter(chain, firstSlot, getCut(first), getSlope(first));
+
+        if (!inDouble)
+            continue;
+
+        for (size_t lane = 0; lane < SIMDFloat::size(); ++lane) {
+            auto& cascade = getPreciseCut(group, lane, isLowCut);
+
+            for (int i = 0; i < numSections; ++i) {
+                if (cascade.isSectionActive(i) && chain.isSectionActive(firstSlot + i))
+                    chain.setState(firstSlot + i, lane, (float) cascade.getState(i, 0, false),
+                                                        (float) cascade.getState(i, 0, true));
+
+                cascade.setSectionActive(i, false);
+            }
+        }
+    }
+
+    inDouble = shouldBeInDouble;
+}
+
+void SimpleEQ1AudioProcessor::resetChains() {
+    for (auto& chain : simdChains)
+        chain.reset();
+
+    for (auto& precise : preciseLanes) {
+        precise.lowCut.reset();
+        precise.highCut.reset();
+    }
+}
+
+//(15) called periodically by the shared design thread
+int SimpleEQ1AudioProcessor::useTimeSlice() {
+    const juce::ScopedLock lock(designLock);
+    runDesignPass();
+
+    return 5; //ms until we want to be polled again
+}
+
+void SimpleEQ1AudioProcessor::runDesignPass() {
+    const auto published = updateFilters();
+    updateLinearPhaseKernel();
+
+    //(16) the latency and the tail only move with a new design, or when the
+    //FIR takes over or hands back, which doesn't redesign anything
+    if (published || isLinearPhaseActive() != latencyIsForLinearPhase) {
+        updateLatency();
+        updateTailLength();
+    }
+}
+
+//(14) helpers for the change tracking
+void SimpleEQ1AudioProcessor::markAllStagesDirty() {
+    for (auto& flag : stageDirty)
+        flag.store(true);
+}
+
+void SimpleEQ1AudioProcessor::parameterChanged(const juce::String& parameterID, float) {
+    //the parameter IDs are prefixed by the stage they belong to
+    if (parameterID.startsWith("LowCut"))
+        stageDirty[LowCut].store(true);
+    else if (parameterID.startsWith("HighCut"))
+        stageDirty[HighCut].store(true);
+    else if (parameterID.startsWith("Peak"))
+        stageDirty[Peak].store(true);
+    else if (parameterID.startsWith("Band"))
+        stageDirty[Bands].store(true);
+    else if (parameterID == "Linear Phase")
+        kernelDirty.store(true);
+    else if (parameterID == "Oversampling" || parameterID == "Channel Mode")
+        markAllStagesDirty();
+}
+
+//(16) parameter smoothing
+void SmoothedChainSettings::reset(double sampleRate, double rampLengthInSeconds, const ChainSettings& initial) {
+    for (auto* smoother : { &peakFreq, &peakQuality, &lowCutFreq, &highCutFreq })
+        smoother->reset(sampleRate, rampLengthInSeconds);
+
+    peakGainInDecibels.reset(sampleRate, rampLengthInSeconds);
+
+    for (size_t band = 0; band < (size_t) BandSettings::maxBands; ++band) {
+        bandFreq[band].reset(sampleRate, rampLengthInSeconds);
+        bandQuality[band].reset(sampleRate, rampLengthInSeconds);
+        bandGainInDecibels[band].reset(sampleRate, rampLengthInSeconds);
+    }
+
+    jumpTo(initial);
+}
+
+void SmoothedChainSettings::jumpTo(const ChainSettings& settings) {
+    peakFreq.setCurrentAndTargetValue(settings.peakFreq);
+    peakQuality.setCurrentAndTargetValue(settings.peakQuality);
+    peakGainInDecibels.setCurrentAndTargetValue(settings.peakGainInDecibels);
+    lowCutFreq.setCurrentAndTargetValue(settings.lowCutFreq);
+    highCutFreq.setCurrentAndTargetValue(settings.highCutFreq);
+
+    for (size_t band = 0; band < (size_t) BandSettings::maxBands; ++band) {
+        bandFreq[band].setCurrentAndTargetValue(settings.bands.freq[band]);
+        bandQuality[band].setCurrentAndTargetValue(settings.bands.quality[band]);
+        bandGainInDecibels[band].setCurrentAndTargetValue(settings.bands.gainInDecibels[band]);
+    }
+
+    current = settings;
+}
+
+void SmoothedChainSettings::setTargets(const ChainSettings& targets) {
+    peakFreq.setTargetValue(targets.peakFreq);
+    peakQuality.setTargetValue(targets.peakQuality);
+    peakGainInDecibels.setTargetValue(targets.peakGainInDecibels);
+    lowCutFreq.setTargetValue(targets.lowCutFreq);
+    highCutFreq.setTargetValue(targets.highCutFreq);
+
+    for (size_t band = 0; band < (size_t) BandSettings::maxBands; ++band) {
+        bandFreq[band].setTargetValue(targets.bands.freq[band]);
+        bandQuality[band].setTargetValue(targets.bands.quality[band]);
+        bandGainInDecibels[band].setTargetValue(targets.bands.gainInDecibels[band]);
+    }
+
+    //the slopes are discrete, there is nothing to ramp
+    //(26) nor are the band switches and types
+    current.lowCutSlope = targets.lowCutSlope;
+    current.highCutSlope = targets.highCutSlope;
+    current.bands.enabled = targets.bands.enabled;
+    current.bands.type = targets.bands.type;
+}
+
+bool SmoothedChainSettings::isSmoothing() const {
+    return isPeakSmoothing() || isLowCutSmoothing() || isHighCutSmoothing() || getSmoothingBands() != 0;
+}
+
+bool SmoothedChainSettings::isPeakSmoothing() const {
+    return peakFreq.isSmoothing() || peakQuality.isSmoothing() || peakGainInDecibels.isSmoothing();
+}
+
+bool SmoothedChainSettings::isLowCutSmoothing() const {
+    return lowCutFreq.isSmoothing();
+}
+
+bool SmoothedChainSettings::isHighCutSmoothing() const {
+    return highCutFreq.isSmoothing();
+}
+
+//(26) a band that's switched off isn't in the cascade, so its ramp doesn't matter
+juce::uint32 SmoothedChainSettings::getSmoothingBands() const {
+    juce::uint32 moving = 0;
+
+    for (size_t band = 0; band < (size_t) BandSettings::maxBands; ++band)
+        if (current.bands.enabled[band]
+            && (bandFreq[band].isSmoothing() || bandQuality[band].isSmoothing() || bandGainInDecibels[band].isSmoothing()))
+            moving |= 1u << band;
+
+    return moving;
+}
+
+ChainSettings SmoothedChainSettings::skip(int numSamples) {
+    current.peakFreq = peakFreq.skip(numSamples);
+    current.peakQuality = peakQuality.skip(numSamples);
+    current.peakGainInDecibels = peakGainInDecibels.skip(numSamples);
+    current.lowCutFreq = lowCutFreq.skip(numSamples);
+    current.highCutFreq = highCutFreq.skip(numSamples);
+
+    for (size_t band = 0; band < (size_t) BandSettings::maxBands; ++band) {
+        current.bands.freq[band] = bandFreq[band].skip(numSamples);
+        current.bands.quality[band] = bandQuality[band].skip(numSamples);
+        current.bands.gainInDecibels[band] = bandGainInDecibels[band].skip(numSamples);
+    }
+
+    return current;
 }
 
 //(1) declare the parameter layout used by the audio processor value tree state
@@ -328,6 +1684,84 @@ SimpleEQ1AudioProcessor::createParameterLayout() {
     layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope", "LowCut Slope", stringArray, 0));
     layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope", "HighCut Slope", stringArray, 0));
 
+    //(20) zero-latency IIR (minimum phase) or linear-phase FIR processing
+    layout.add(std::make_unique<juce::AudioParameterBool>("Linear Phase", "Linear Phase", false));
+
+    //(21) oversampling around the IIR cascade
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling", "Oversampling",
+                                                            juce::StringArray{ "Off", "2x", "4x" }, 0));
+
+    //(27) how a stereo bus is split between the two parameter sets, and the
+    //second set itself (the side, or right, channel's cuts and peak)
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Channel Mode", "Channel Mode",
+                                                            juce::StringArray{ "Stereo", "Mid/Side", "Left/Right" }, 0));
+
+    for (int set = 1; set < ChannelCoefficients::numSets; ++set) {
+        auto addFloat = [&](const char* parameterID, juce::NormalisableRange<float> range, float defaultValue) {
+            auto id = getChannelParameterID(parameterID, set);
+            layout.add(std::make_unique<juce::AudioParameterFloat>(id, id, range, defaultValue));
+        };
+
+        addFloat("LowCut Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, .25f), 20.f);
+        addFloat("HighCut Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, .25f), 20000.f);
+        addFloat("Peak Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, .25f), 750.f);
+        addFloat("Peak Gain", juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f), 0.0f);
+        addFloat("Peak Quality", juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f), 1.f);
+
+        for (auto* parameterID : { "LowCut Slope", "HighCut Slope" }) {
+            auto id = getChannelParameterID(parameterID, set);
+            layout.add(std::make_unique<juce::AudioParameterChoice>(id, id, stringArray, 0));
+        }
+    }
+
+    //(26) the extra bands, all switched off by default and spread across the spectrum
+    const juce::StringArray bandTypes{ "Peak", "Low Shelf", "High Shelf", "Notch", "Band Pass" };
+
+    for (int band = 0; band < BandSettings::maxBands; ++band) {
+        auto defaultFreq = 20.f * std::pow(1000.f, (band + 0.5f) / BandSettings::maxBands);
+
+        layout.add(std::make_unique<juce::AudioParameterBool>(
+            getBandParameterID(band, "On"), getBandParameterID(band, "On"), false));
+
+        layout.add(std::make_unique<juce::AudioParameterChoice>(
+            getBandParameterID(band, "Type"), getBandParameterID(band, "Type"), bandTypes, 0));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            getBandParameterID(band, "Freq"), getBandParameterID(band, "Freq"),
+            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, .25f), std::round(defaultFreq)));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            getBandParameterID(band, "Gain"), getBandParameterID(band, "Gain"),
+            juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f), 0.f));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            getBandParameterID(band, "Quality"), getBandParameterID(band, "Quality"),
+            juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f), 1.f));
+    }
+
+    //(33) loudness compensation after the high cut
+    layout.add(std::make_unique<juce::AudioParameterBool>("Auto Gain", "Auto Gain", false));
+
+    //(25) dynamic EQ: above the threshold the peak band moves towards "Peak Gain"
+    layout.add(std::make_unique<juce::AudioParameterBool>("Dynamic", "Dynamic", false));
+    layout.add(std::make_unique<juce::AudioParameterBool>("Dynamic Sidechain", "Dynamic Sidechain", false));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "Dynamic Threshold", "Dynamic Threshold",
+        juce::NormalisableRange<float>(-60.f, 0.f, 0.1f, 1.f), -20.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "Dynamic Ratio", "Dynamic Ratio",
+        juce::NormalisableRange<float>(1.f, 20.f, 0.1f, 0.4f), 2.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "Dynamic Attack", "Dynamic Attack",
+        juce::NormalisableRange<float>(0.1f, 200.f, 0.1f, 0.4f), 10.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        "Dynamic Release", "Dynamic Release",
+        juce::NormalisableRange<float>(5.f, 2000.f, 1.f, 0.4f), 100.f));
+
     return layout;
 }
 
@@ -9,6 +9,16 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "CoefficientHandoff.h"
+#include "BiquadDesign.h"
+#include "BiquadCascade.h"
+#include "LinearPhaseEngine.h"
+#include "SpectrumAnalyzer.h"
+#include "DynamicPeak.h"
+#include "ButterworthCache.h"
+#include "ProcessingArena.h"
+#include "AutoGain.h"
+#include "ProcessingProfiler.h"
 
 //(9) create enum for the slope parameters
 enum Slope {
@@ -18,6 +28,32 @@ enum Slope {
     Slope_48
 };
 
+//(26) the filter types the extra bands can take
+enum BandType {
+    Band_Peak,
+    Band_LowShelf,
+    Band_HighShelf,
+    Band_Notch,
+    Band_BandPass
+};
+
+//(27) how the two channels of a stereo bus are filtered
+enum ChannelMode {
+    Channels_Stereo,        //both channels share the first parameter set
+    Channels_MidSide,       //first set on the mid, second set on the side
+    Channels_LeftRight      //first set on the left, second set on the right
+};
+
+//(26) the extra bands, stored structure-of-arrays style (one array per
+//band parameter), so walking one parameter across all bands is contiguous
+struct BandSettings {
+    static constexpr int maxBands = CoefficientSet::maxBands;
+
+    std::array<bool, maxBands> enabled{};
+    std::array<BandType, maxBands> type{};
+    std::array<float, maxBands> freq{}, gainInDecibels{}, quality{};
+};
+
 
 //(6) extract the APVTS parameters and group them in a structure
 struct ChainSettings {
@@ -28,14 +64,77 @@ struct ChainSettings {
           highCutFreq{ 0 };
     Slope lowCutSlope{ Slope::Slope_12 },    //these get modified at (9)
           highCutSlope{ Slope::Slope_12 };
+    BandSettings bands;                     //(26)
+};
+
+//(26) raw parameter pointers, looked up once, so that getting the settings
+//on the audio thread really is just a handful of atomic loads
+struct ChainParameters {
+    explicit ChainParameters(juce::AudioProcessorValueTreeState& apvts);
+
+    //(27) one per channel set; the extra bands are shared by both
+    struct Channel {
+        std::atomic<float> *lowCutFreq, *highCutFreq, *lowCutSlope, *highCutSlope,
+                           *peakFreq, *peakGain, *peakQuality;
+    };
+
+    std::array<Channel, ChannelCoefficients::numSets> channels;
+
+    struct Band {
+        std::atomic<float> *enabled, *type, *freq, *gain, *quality;
+    };
+
+    std::array<Band, BandSettings::maxBands> bands;
 };
 
+//(26) "Band<n> <name>", with n counting from 1
+juce::String getBandParameterID(int band, const juce::String& name);
+
+//(27) the second channel set's parameters are the first set's IDs + " 2"
+juce::String getChannelParameterID(const juce::String& parameterID, int channelSet);
+
+ChainSettings getChainSettings(const ChainParameters& parameters, int channelSet = 0);
 ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
 
+//(16) ramps the continuous ChainSettings fields towards the latest parameter
+//values, so automation sweeps smoothly instead of jumping once per block
+struct SmoothedChainSettings {
+    void reset(double sampleRate, double rampLengthInSeconds, const ChainSettings& initial);
+    void setTargets(const ChainSettings& targets);
+
+    //(22) ends every ramp at once, e.g. after a state restore
+    void jumpTo(const ChainSettings& settings);
+
+    bool isSmoothing() const;
+    bool isPeakSmoothing() const;
+    bool isLowCutSmoothing() const;
+    bool isHighCutSmoothing() const;
+
+    //(26) bit n is set while (switched on) band n is ramping
+    juce::uint32 getSmoothingBands() const;
+
+    //advances every ramp by numSamples and returns the settings reached
+    ChainSettings skip(int numSamples);
+
+private:
+    using Multiplicative = juce::ValueSmoothingTypes::Multiplicative;
+
+    juce::SmoothedValue<float, Multiplicative> peakFreq, peakQuality, lowCutFreq, highCutFreq;
+    juce::SmoothedValue<float> peakGainInDecibels;
+
+    //(26)
+    std::array<juce::SmoothedValue<float, Multiplicative>, BandSettings::maxBands> bandFreq, bandQuality;
+    std::array<juce::SmoothedValue<float>, BandSettings::maxBands> bandGainInDecibels;
+
+    ChainSettings current;
+};
+
 //==============================================================================
 /**
 */
-class SimpleEQ1AudioProcessor  : public juce::AudioProcessor
+class SimpleEQ1AudioProcessor  : public juce::AudioProcessor,
+                                 private juce::AudioProcessorValueTreeState::Listener,
+                                 private juce::TimeSliceClient
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
@@ -55,6 +154,11 @@ public:
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
+    //(29) double buffers run through the same engine, whose precision-critical
+    //stages are already computed in double
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
+
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -84,80 +188,361 @@ public:
     
     juce::AudioProcessorValueTreeState apvts{*this, nullptr, "Parameters", createParameterLayout()};
 
+    //(16) while a parameter ramps, the moving stages get redesigned every
+    //"stride" samples; the ramp length is picked up on the next prepareToPlay
+    void setSmoothingStride(int numSamples) { smoothingStride.store(juce::jmax(1, numSamples)); }
+    void setSmoothingTime(double seconds)   { smoothingTimeSeconds.store(juce::jmax(0.0, seconds)); }
+
+    //(23) pre/post EQ taps for the spectrum analyzer; only filled while active
+    AnalyzerFifo preEqFifo, postEqFifo;
+
+    //(24) message thread: copies the latest designed coefficients, unless the
+    //design thread is busy with them right now (then try again next time)
+    bool getCoefficientsForDisplay(ChannelCoefficients& destination);
+
+    //(34) channels are filtered in groups of this many, one per SIMD lane,
+    //so a caller that owns several independent streams (the batch renderer)
+    //can pack them side by side into one processor instead of leaving lanes idle.
+    //Plugin instances in a host are deliberately not batched together: each
+    //processBlock has to hand its output back before the host calls the
+    //next instance (or while others run on other threads), so sharing lanes
+    //across instances would take a barrier between audio threads or an
+    //extra block of latency. Inside a host, lanes are only shared between
+    //an instance's own channels.
+    static constexpr size_t getNumLanes() noexcept { return juce::dsp::SIMDRegister<float>::size(); }
+
+    //(34) true when no stage mixes channels, so packed streams come out as
+    //they would on their own: not in the Mid/Side or Left/Right modes, and
+    //not with the dynamic peak or auto gain, which listen to every channel
+    bool processesChannelsIndependently() const;
+
+    //(33) how long the level-dependent stages (the dynamic peak's envelope,
+    //the Auto Gain meters and gain) take to forget the state they started
+    //from, to about -60 dB. An offline render that starts in the middle of a
+    //file pre-rolls this long on top of the tail. 0 when neither is on.
+    double getSettlingTimeSeconds() const;
+
+   #if SIMPLEEQ_ENABLE_PROFILING
+    //(31) per-stage timings, read by the editor's overlay
+    ProcessingProfiler profiler;
+   #endif
+
 private:
 
     //(3) create aliases for all the namespaces in the juce::dsp modules
 
-    //peak filter
-    using Filter = juce::dsp::IIR::Filter<float>;
+    //(17) every lane of a SIMDRegister carries one channel, so a single chain
+    //filters several channels at once with the same coefficients
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
 
-    //adjustable slope filter (LP or HP)
-    using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+    //(7) definition of enum to access the links in the chain
+    enum ChainPositions {
+        LowCut, Peak, HighCut,
+        Bands,                  //(26)
+        NumChainPositions
+    };
 
-    //mono chain (LP + parametric + HP)
-    using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+    //(19) each link owns fixed slots in the cascade: up to 4 biquads for each
+    //cut filter (one per 12 dB/Oct) and one for the peak
+    //(26) plus one per extra band, between the peak and the high cut.
+    //Switched off bands aren't in the cascade's active list, so the cost
+    //follows the number of bands in use, not maxBands.
+    enum ChainSlots {
+        LowCutSlot = 0,
+        PeakSlot = 4,
+        BandSlot = 5,
+        HighCutSlot = BandSlot + BandSettings::maxBands,
+        NumChainSlots = HighCutSlot + 4
+    };
 
-    MonoChain leftChain, rightChain;
+    //mono chain (LP + parametric + HP)
+    //(17) "mono" because it runs on a single interleaved stream of SIMDFloat frames
+    //(19) a fused biquad cascade instead of a ProcessorChain of bypassable Filters,
+    //so every active section runs on a sample in one pass over the buffer
+    using MonoChain = BiquadCascade<SIMDFloat, NumChainSlots>;
+
+    //(32) the chains, the precise lanes and every scratch buffer below are
+    //carved out of this in prepareToPlay. It's sized for the most channels
+    //and the biggest block prepared so far, so preparing again for another
+    //rate or a smaller block only resets them in place.
+    ProcessingArena arena;
+    size_t arenaChannels = 0;
+    int arenaBlockSize = 0;
+
+    void prepareArena(size_t numChannels, int samplesPerBlock);
+
+    //(18) one chain per group of SIMDFloat::size() channels, sized in prepareToPlay,
+    //so any channel layout (mono, 7.1.4, ambisonics...) runs through the same engine
+    ArenaArray<MonoChain> simdChains;
+
+    //(17) scratch space the channels get interleaved into before filtering
+    ArenaArray<SIMDFloat> interleaved;
+
+    //(29) a cut filter close to DC has its poles right next to z = 1, where a
+    //float state can't resolve the tiny differences that define the filter
+    //(48 dB/Oct at 20 Hz and 192 kHz is just noise). Below this cutoff/sample
+    //rate ratio the whole cut stage runs in double precision instead, one
+    //scalar cascade per lane, and everything else stays in the SIMD floats.
+    static constexpr double doublePrecisionRatio = 0.001;
+
+    static bool needsDoublePrecision(double frequency, double sampleRate) noexcept {
+        return frequency < sampleRate * doublePrecisionRatio;
+    }
 
+    using PreciseCut = BiquadCascade<double, 4>;
 
-    //(7) definition of enum to access the links in the chain
-    enum ChainPositions {
-        LowCut, Peak, HighCut
+    struct PreciseLane {
+        PreciseCut lowCut, highCut;
     };
 
-    //(10) refactoring (start with stuff that configures the peak filter)
-    void updatePeakFilter(const ChainSettings& chainSettings);
+    //(29) simdChains.size() * SIMDFloat::size() of them, lane by lane
+    ArenaArray<PreciseLane> preciseLanes;
+    bool lowCutInDouble = false, highCutInDouble = false;   //audio thread only
 
-    //(10) create alias for IIR coefficients
-    using Coefficients = Filter::CoefficientsPtr;
-    
-    //(10) function for updating cut filter coefficients
-    static void updateCoefficients(Coefficients& old, const Coefficients& replacements);
-
-    //(11.a) helper function for the switch statement in the function updateutFilter
-    template<int Index, typename ChainType, typename CoefficientType>
-    void update(ChainType& chain, const CoefficientType& coefficients) {
-        updateCoefficients(chain.get<Index>().coefficients, coefficients[Index]);
-        chain.setBypassed<Index>(false);
+    PreciseCut& getPreciseCut(size_t group, size_t lane, bool isLowCut) {
+        auto& precise = preciseLanes[group * SIMDFloat::size() + lane];
+        return isLowCut ? precise.lowCut : precise.highCut;
     }
 
-    //(11) refactoring of the low cut filter coefficients
-    template<typename ChainType, typename CoefficientType>
-        void updateCutFilter(
-            ChainType& leftLowCut,
-            const CoefficientType& cutCoefficients,
-            const Slope& lowCutSlope) {
-            
-            leftLowCut.setBypassed<0>(true);
-            leftLowCut.setBypassed<1>(true);
-            leftLowCut.setBypassed<2>(true);
-            leftLowCut.setBypassed<3>(true);
-
-            //(9.a) switch case for low cut params
-            switch (lowCutSlope) {
-
-            case Slope_48:{
-                update<3>(leftLowCut, cutCoefficients);
-                }
-            case Slope_36:{
-                update<2>(leftLowCut, cutCoefficients);
-                }
-            case Slope_24:{
-                update<1>(leftLowCut, cutCoefficients);
-                }
-            case Slope_12:{
-                update<0>(leftLowCut, cutCoefficients);
-                }
-            }
+    void applyCutStage(bool isLowCut, const ChannelCoefficients& coefficients, bool perLane);
+    void resetChains();
+
+    //(29) the double processBlock converts into this, sized in prepareToPlay
+    //(32) one arena channel per bus channel, wrapped in a buffer per chunk
+    ArenaArray<float*> conversionChannels;
+    int conversionBlockSize = 0;
 
+    //(27) the settings of both channel sets, e.g. mid and side
+    using ChannelSettings = std::array<ChainSettings, ChannelCoefficients::numSets>;
+
+    //(10) refactoring (start with stuff that configures the peak filter)
+    //(27) the update* functions design the first channel set, and the second
+    //one only when it's in use and its settings differ from the first's
+    void updatePeakFilter(const ChannelSettings& chainSettings);
+
+    //(16) allocation-free designs shared by the design thread and the smoothing ramps
+    static void designPeakFilter(const ChainSettings& chainSettings, double sampleRate, CoefficientSet& destination);
+    //(30) the cut designs go through the shared cache when one is given
+    static void designLowCutFilter(const ChainSettings& chainSettings, double sampleRate, CoefficientSet& destination,
+                                   ButterworthCache* cache = nullptr);
+    static void designHighCutFilter(const ChainSettings& chainSettings, double sampleRate, CoefficientSet& destination,
+                                    ButterworthCache* cache = nullptr);
+
+    //(11) refactoring of the cut filter coefficients
+    //(19) one section per 12 dB/Oct is switched on, the others cost nothing
+    static void updateCutFilter(
+        MonoChain& chain,
+        int firstSlot,
+        const std::array<BiquadCoefficients, 4>& cutCoefficients,
+        const Slope& slope) {
+
+        for (int i = 0; i < (int) cutCoefficients.size(); ++i) {
+            if (i <= slope)
+                chain.setSection(firstSlot + i, cutCoefficients[(size_t) i]);
+
+            chain.setSectionActive(firstSlot + i, i <= slope);
+        }
+    }
+
+    //(27) per-lane version: lane 0 follows the first set and lane 1 the second.
+    //A slot is switched on when either channel needs it, and the channel that
+    //doesn't gets a pass-through section there.
+    static void updateCutFilter(
+        MonoChain& chain,
+        int firstSlot,
+        const std::array<BiquadCoefficients, 4>& firstCoefficients,
+        const Slope& firstSlope,
+        const std::array<BiquadCoefficients, 4>& secondCoefficients,
+        const Slope& secondSlope) {
+
+        for (int i = 0; i < (int) firstCoefficients.size(); ++i) {
+            chain.setSection(firstSlot + i, 0, i <= firstSlope ? firstCoefficients[(size_t) i] : BiquadCoefficients{});
+            chain.setSection(firstSlot + i, 1, i <= secondSlope ? secondCoefficients[(size_t) i] : BiquadCoefficients{});
+            chain.setSectionActive(firstSlot + i, i <= firstSlope || i <= secondSlope);
+        }
     }
 
     //(13) 
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
+    //(15) these now only design into designedCoefficients, they don't touch the chains
+    void updateLowCutFilters(const ChannelSettings& chainSettings);
+    void updateHighCutFilters(const ChannelSettings& chainSettings);
+
+    //(26) the extra bands are cheap closed-form designs, so they're all
+    //redesigned together whenever any of them changes
+    static BiquadCoefficients designBand(const ChainSettings& chainSettings, int band, double sampleRate);
+    static void designBands(const ChainSettings& chainSettings, double sampleRate, CoefficientSet& destination);
+    void updateBands(const ChannelSettings& chainSettings);
+
+    //(27) whether the two channel sets have identical settings for a stage,
+    //in which case the second set just copies the first one's coefficients
+    static bool isStageShared(int chainPosition, const ChainSettings& first, const ChainSettings& second);
+    static void copyStage(int chainPosition, const CoefficientSet& source, CoefficientSet& destination);
+
+    static void designStage(int chainPosition, const ChannelSettings& chainSettings, int numSets,
+                            double sampleRate, ChannelCoefficients& destination, ButterworthCache* cache = nullptr);
+    void updateStage(int chainPosition, const ChannelSettings& chainSettings);
+
+    ChannelSettings getChannelSettings() const;
+    int getNumChannelSets(int channelMode) const { return channelMode != Channels_Stereo && isStereoLayout ? 2 : 1; }
 
     //(13) function that updates all the filters
-    void updateFilters();
+    //(15) runs on the design thread (or under designLock) and publishes the result
+    //(16) returns false when nothing was dirty, so nothing was published
+    bool updateFilters();
+
+    //(16) one round of design work (holding designLock): the filters, the FIR
+    //kernel, and the latency and tail when those can have changed
+    void runDesignPass();
+
+    //(14) change tracking: one dirty flag per chain position, raised by the
+    //APVTS listener and consumed by updateFilters(), so only the stage whose
+    //parameters actually moved gets redesigned
+    std::atomic<bool> stageDirty[NumChainPositions];
+
+    void markAllStagesDirty();
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+
+    //(26) the parameter pointers getChainSettings() reads from
+    ChainParameters chainParameters{ apvts };
+
+    //(15) coefficient handoff: designed on the shared design thread, published
+    //through a wait-free triple buffer and copied into the chains in processBlock
+    juce::SharedResourcePointer<CoefficientDesignThread> designThread;
+
+    //(30) cut designs shared by every instance, used by the design thread only
+    juce::SharedResourcePointer<ButterworthCache> butterworthCache;
+    juce::CriticalSection designLock;       //only ever taken by non-realtime threads
+    std::atomic<double> designSampleRate{ 0.0 };
+
+    ChannelCoefficients designedCoefficients;   //owned by whoever holds designLock
+    TripleBuffer<ChannelCoefficients> coefficientMailbox;
+    std::array<decltype(CoefficientSet::generations), ChannelCoefficients::numSets> appliedGenerations{};
+
+    const ChannelCoefficients* heldCoefficients = nullptr;     //(16) audio thread only
+
+    void applyPendingCoefficients(juce::uint32 rampingStages = 0, juce::uint32 rampingBands = 0);
+    void applyStage(int chainPosition, const ChannelCoefficients& coefficients, juce::uint32 skippedBands = 0);
+    int useTimeSlice() override;
+
+    //(27) Mid/Side and Left/Right only apply to a stereo main bus; any other
+    //layout is always filtered with the first channel set
+    std::atomic<float>* channelModeParameter = nullptr;
+    std::atomic<bool> isStereoLayout{ false };
+    int activeChannelMode = Channels_Stereo;    //audio thread only
+
+    int getChannelMode() const { return juce::jlimit(0, 2, (int) channelModeParameter->load()); }
+
+    //(16) parameter smoothing, only ever touched by the audio thread
+    //(27) one set of ramps per channel set
+    std::array<SmoothedChainSettings, ChannelCoefficients::numSets> smoothedSettings;
+    ChannelCoefficients rampCoefficients;
+    std::atomic<int> smoothingStride{ 32 };
+    std::atomic<double> smoothingTimeSeconds{ 0.05 };
+
+    //(17) interleave -> filter -> deinterleave, in chunks of the scratch size
+    void processChains(juce::dsp::AudioBlock<float>& block);
+
+    //(20) linear-phase mode: the FIR kernel is rebuilt on the design thread,
+    //at most once every kernelUpdateIntervalMs while parameters keep moving
+    static constexpr juce::uint32 kernelUpdateIntervalMs = 50;
+
+    LinearPhaseEngine linearPhaseEngine;
+    std::atomic<float>* linearPhaseParameter = nullptr;
+    std::atomic<bool> kernelDirty{ true };
+    juce::uint32 lastKernelUpdateTime = 0;
+    bool linearPhaseWasActive = false;      //audio thread only
+
+    bool isLinearPhaseEnabled() const { return linearPhaseParameter->load() > 0.5f; }
+    void updateLinearPhaseKernel();
+
+    //(20) the FIR only takes over once it has a kernel
+    bool isLinearPhaseActive() const { return isLinearPhaseEnabled() && linearPhaseEngine.hasKernel(); }
+    bool latencyIsForLinearPhase = false;   //(16) what updateLatency() last reported, under designLock
+
+    //(21) optional 2x/4x oversampling around the IIR cascade. Both oversamplers
+    //are built in prepareToPlay; index 0 means no oversampling.
+    static constexpr int maxOversamplingFactor = 4;
+
+    std::array<std::unique_ptr<juce::dsp::Oversampling<float>>, 3> oversamplers;
+    size_t oversamplingChannels = 0;
+    int oversamplingBlockSize = 0;          //(32) what they were last initialised for
+    std::atomic<float>* oversamplingParameter = nullptr;
+
+    int activeOversampling = 0;             //audio thread only
+    double processingSampleRate = 0.0;      //audio thread only
+
+    int getOversamplingIndex() const { return juce::jlimit(0, 2, (int) oversamplingParameter->load()); }
+    void updateLatency();
+
+    //(23) everything processBlock does to the main bus, between the analyzer taps
+    //(25) key is what the dynamic peak listens to (main input or sidechain)
+    void processMainBus(juce::dsp::AudioBlock<float>& block, const juce::dsp::AudioBlock<const float>& key);
+
+    //(21) the smoothing ramps + IIR cascade, at whatever rate the block is at
+    //(25) key stays at the host rate
+    void processFilters(juce::dsp::AudioBlock<float>& block, int oversamplingFactor,
+                        const juce::dsp::AudioBlock<const float>& key);
+
+    //(27) whether either channel set in use is still ramping
+    bool isRamping() const;
+
+    //(16) bit n is set while chain position n is being ramped in either set;
+    //the bands ramp one by one (and are shared by both sets)
+    juce::uint32 getRampingStages() const;
+    juce::uint32 getRampingBands() const { return smoothedSettings[0].getSmoothingBands(); }
+
+    //(28) silence detection: -120 dB is both what counts as silent input and
+    //how far the filters have to ring out before they're switched off
+    static constexpr float silenceThresholdInDecibels = -120.f;
+    static constexpr double maxTailLengthSeconds = 10.0;
+
+    std::atomic<double> tailLengthSeconds{ 0.0 };
+    juce::int64 silentSamples = 0;          //audio thread only
+    bool silenceBypassed = false;           //audio thread only
+
+    void updateTailLength();
+    bool processSilence(juce::dsp::AudioBlock<float>& block);
+
+    //(25) dynamic EQ mode for the peak band (IIR engine only): the peak
+    //coefficients are updated once per smoothing stride from the envelope
+    DynamicPeak dynamicPeak;
+    ArenaArray<float> keyScratch;           //(32) the detector's mixdown, in the arena
+    std::atomic<float>* dynamicParameter = nullptr;
+    std::atomic<float>* dynamicSidechainParameter = nullptr;
+    std::atomic<float>* dynamicThresholdParameter = nullptr;
+    std::atomic<float>* dynamicRatioParameter = nullptr;
+    std::atomic<float>* dynamicAttackParameter = nullptr;
+    std::atomic<float>* dynamicReleaseParameter = nullptr;
+    bool dynamicWasActive = false;          //audio thread only
+
+    bool isDynamicEnabled() const { return dynamicParameter->load() > 0.5f; }
+    DynamicPeak::Parameters getDynamicParameters() const;
+
+    //(33) loudness compensation after the high cut (IIR engine only): the
+    //chain's input and output are K-weighted and metered, and a smoothed
+    //make-up gain brings the output back to the input's loudness
+    AutoGain autoGain;
+    ArenaArray<AutoGain::GroupState> autoGainStates;     //one per chain, in the arena
+    std::atomic<float>* autoGainParameter = nullptr;
+
+    bool isAutoGainEnabled() const { return autoGainParameter->load() > 0.5f; }
+
+    //(22) compact binary state: a small header followed by one
+    //(parameter ID hash, normalised value) pair per parameter
+    static constexpr int stateMagic = 0x31514553; //"SEQ1"
+    static constexpr int stateVersion = 1;
+
+    std::vector<juce::RangedAudioParameter*> stateParameters;
+    std::unordered_map<int, size_t> stateParameterIndexByHash;
+
+    //(22) marks a hash more than one parameter ID maps to
+    static constexpr size_t ambiguousStateEntry = std::numeric_limits<size_t>::max();
+    bool binaryStateIsUnambiguous = true;
+
+    //(22) set by a state restore, consumed by the audio thread
+    std::atomic<bool> jumpToRestoredSettings{ false };
+
+    bool restoreBinaryState(juce::MemoryInputStream& stream);
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleEQ1AudioProcessor)
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    ProcessingArena.h
+
+    One block of memory per plugin instance holding the state the audio
+    thread works on: the filter chains, the double-precision cut lanes and
+    the scratch buffers. prepareToPlay carves them out of it again on every
+    call, and the block only grows when a configuration bigger than any seen
+    before shows up, so re-preparing for another sample rate or a smaller
+    block size just resets the state in place instead of reallocating.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class ProcessingArena {
+public:
+    //(32) enough for any SIMD register and a cache line, so carved objects never share one
+    static constexpr size_t alignment = 64;
+
+    static constexpr size_t roundUp(size_t numBytes) noexcept {
+        return (numBytes + alignment - 1) & ~(alignment - 1);
+    }
+
+    //(32) bytes taken by count objects of type T, padding included
+    template <typename T>
+    static constexpr size_t bytesFor(size_t count) noexcept {
+        return roundUp(count * sizeof(T));
+    }
+
+    //(32) makes room for at least numBytes; returns true when that meant a
+    //new allocation. Everything carved before is invalid after that.
+    bool reserve(size_t numBytes) {
+        numBytes = roundUp(numBytes);
+
+        if (numBytes <= capacity)
+            return false;
+
+        storage.free();
+        storage.calloc(numBytes + alignment);
+
+        auto address = reinterpret_cast<juce::pointer_sized_uint>(storage.get());
+        base = storage.get() + (roundUp((size_t) address) - (size_t) address);
+        capacity = numBytes;
+        used = 0;
+        return true;
+    }
+
+    //(32) starts carving from the beginning again
+    void rewind() noexcept { used = 0; }
+
+    //(32) the next count objects, default-constructed in place. The arena
+    //never runs destructors, so only trivially destructible types live here.
+    template <typename T>
+    T* carve(size_t count) noexcept {
+        static_assert(std::is_trivially_destructible<T>::value, "the arena never destroys what it holds");
+        static_assert(alignof(T) <= alignment, "over-aligned type");
+
+        const auto numBytes = bytesFor<T>(count);
+        jassert(used + numBytes <= capacity);
+
+        if (count == 0 || used + numBytes > capacity)
+            return nullptr;
+
+        auto* objects = reinterpret_cast<T*>(base + used);
+        used += numBytes;
+
+        for (size_t i = 0; i < count; ++i)
+            new (objects + i) T();
+
+        return objects;
+    }
+
+    size_t getCapacity() const noexcept { return capacity; }
+    size_t getNumBytesUsed() const noexcept { return used; }
+
+private:
+    juce::HeapBlock<char> storage;
+    char* base = nullptr;
+    size_t capacity = 0, used = 0;
+};
+
+//(32) a fixed-size run of objects carved from a ProcessingArena, with just
+//enough of std::vector's interface for range-for loops and indexing
+template <typename T>
+class ArenaArray {
+public:
+    ArenaArray() = default;
+    ArenaArray(T* dataToUse, size_t numObjects) noexcept : objects(dataToUse), num(numObjects) {}
+
+    T* begin() const noexcept { return objects; }
+    T* end() const noexcept { return objects + num; }
+    T* data() const noexcept { return objects; }
+
+    size_t size() const noexcept { return num; }
+    bool empty() const noexcept { return num == 0; }
+
+    T& operator[](size_t index) const noexcept {
+        jassert(index < num);
+        return objects[index];
+    }
+
+private:
+    T* objects = nullptr;
+    size_t num = 0;
+};
@@ -0,0 +1,218 @@
+/*
+  ==============================================================================
+
+    ProcessingProfiler.cpp
+
+  ==============================================================================
+*/
+
+#include "ProcessingProfiler.h"
+
+#if SIMPLEEQ_ENABLE_PROFILING
+
+const char* ProcessingProfiler::getStageName(int stage) noexcept {
+    switch (stage) {
+        case Block:             return "block";
+        case Design:            return "design";
+        case ApplyCoefficients: return "applyCoefficients";
+        case Ramps:             return "ramps";
+        case Filters:           return "filters";
+        case Oversampling:      return "oversampling";
+        case LinearPhase:       return "linearPhase";
+        case Analyzer:          return "analyzer";
+        default:                return "";
+    }
+}
+
+void ProcessingProfiler::beginBlock(int numSamples, double sampleRate) noexcept {
+    current = {};
+    current.numSamples = numSamples;
+    current.sampleRate = sampleRate;
+    current.startTicks = now();
+}
+
+void ProcessingProfiler::endBlock() noexcept {
+    current.ticks[Block] = now() - current.startTicks;
+
+    if (!blocks.push(current))
+        droppedRecords.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ProcessingProfiler::addDesignTime(juce::int64 ticks) noexcept {
+    if (!designs.push(ticks))
+        droppedRecords.fetch_add(1, std::memory_order_relaxed);
+}
+
+namespace {
+    //(31) mean, 99th percentile and maximum of a set of values
+    ProcessingProfiler::StageStatistics summarise(std::vector<double>& values) {
+        ProcessingProfiler::StageStatistics statistics;
+
+        if (values.empty())
+            return statistics;
+
+        statistics.meanMicroseconds = std::accumulate(values.begin(), values.end(), 0.0) / (double) values.size();
+        statistics.maxMicroseconds = *std::max_element(values.begin(), values.end());
+
+        auto p99 = values.begin() + (std::ptrdiff_t) ((values.size() - 1) * 99 / 100);
+        std::nth_element(values.begin(), p99, values.end());
+        statistics.p99Microseconds = *p99;
+
+        return statistics;
+    }
+}
+
+ProcessingProfiler::Statistics ProcessingProfiler::getStatistics() {
+    const auto microsecondsPerTick = 1.0e6 / (double) juce::Time::getHighResolutionTicksPerSecond();
+
+    //(31) fold the new records into the history rings
+    blocks.pull([this](const BlockRecord& record) {
+        if ((int) blockHistory.size() < historySize)
+            blockHistory.push_back(record);
+        else
+            blockHistory[(size_t) nextBlock] = record;
+
+        nextBlock = (nextBlock + 1) % historySize;
+        ++totalBlocks;
+        coefficientUpdates += record.coefficientUpdates;
+
+        if (record.sampleRate > 0.0) {
+            const auto budgetMicroseconds = 1.0e6 * record.numSamples / record.sampleRate;
+
+            if ((double) record.ticks[Block] * microsecondsPerTick > budgetMicroseconds * xrunRiskBudgetFraction)
+                ++xrunRiskBlocks;
+        }
+    });
+
+    designs.pull([this](juce::int64 ticks) {
+        if ((int) designHistory.size() < historySize)
+            designHistory.push_back(ticks);
+        else
+            designHistory[(size_t) nextDesign] = ticks;
+
+        nextDesign = (nextDesign + 1) % historySize;
+        ++totalDesigns;
+    });
+
+    Statistics statistics;
+    std::vector<double> values;
+    values.reserve(blockHistory.size());
+
+    for (int stage = 0; stage < NumStages; ++stage) {
+        values.clear();
+
+        for (auto& record : blockHistory)
+            values.push_back((double) record.ticks[(size_t) stage] * microsecondsPerTick);
+
+        statistics.stages[(size_t) stage] = summarise(values);
+    }
+
+    values.clear();
+
+    for (auto& record : blockHistory)
+        if (record.sampleRate > 0.0 && record.numSamples > 0)
+            values.push_back(100.0 * (double) record.ticks[Block] * microsecondsPerTick
+                             / (1.0e6 * record.numSamples / record.sampleRate));
+
+    auto budget = summarise(values);
+    statistics.meanBudgetPercent = budget.meanMicroseconds;
+    statistics.p99BudgetPercent = budget.p99Microseconds;
+    statistics.maxBudgetPercent = budget.maxMicroseconds;
+
+    values.clear();
+
+    for (auto ticks : designHistory)
+        values.push_back((double) ticks * microsecondsPerTick);
+
+    statistics.designThread = summarise(values);
+
+    statistics.numBlocks = (int) blockHistory.size();
+    statistics.totalBlocks = totalBlocks;
+    statistics.xrunRiskBlocks = xrunRiskBlocks;
+    statistics.droppedRecords = droppedRecords.load();
+    statistics.coefficientUpdates = coefficientUpdates;
+    statistics.designs = totalDesigns;
+    return statistics;
+}
+
+juce::var ProcessingProfiler::toJson(const Statistics& statistics) {
+    auto toObject = [](const StageStatistics& stage) {
+        auto* object = new juce::DynamicObject();
+        object->setProperty("meanUs", stage.meanMicroseconds);
+        object->setProperty("p99Us", stage.p99Microseconds);
+        object->setProperty("maxUs", stage.maxMicroseconds);
+        return juce::var(object);
+    };
+
+    auto* stages = new juce::DynamicObject();
+
+    for (int stage = 0; stage < NumStages; ++stage)
+        stages->setProperty(getStageName(stage), toObject(statistics.stages[(size_t) stage]));
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("stages", juce::var(stages));
+    report->setProperty("designThread", toObject(statistics.designThread));
+    report->setProperty("blocksInHistory", statistics.numBlocks);
+    report->setProperty("meanBudgetPercent", statistics.meanBudgetPercent);
+    report->setProperty("p99BudgetPercent", statistics.p99BudgetPercent);
+    report->setProperty("maxBudgetPercent", statistics.maxBudgetPercent);
+    report->setProperty("totalBlocks", statistics.totalBlocks);
+    report->setProperty("xrunRiskBlocks", statistics.xrunRiskBlocks);
+    report->setProperty("droppedRecords", statistics.droppedRecords);
+    report->setProperty("coefficientUpdates", statistics.coefficientUpdates);
+    report->setProperty("designs", statistics.designs);
+    return juce::var(report);
+}
+
+bool ProcessingProfiler::writeReport(const juce::File& file) {
+    return file.replaceWithText(juce::JSON::toString(toJson(getStatistics())));
+}
+
+//==============================================================================
+ProfilerOverlay::ProfilerOverlay(ProcessingProfiler& profilerToUse) : profiler(profilerToUse) {
+    setOpaque(false);
+    startTimerHz(4);
+}
+
+void ProfilerOverlay::timerCallback() {
+    statistics = profiler.getStatistics();
+    repaint();
+}
+
+void ProfilerOverlay::mouseUp(const juce::MouseEvent&) {
+    auto file = juce::File::getSpecialLocation(juce::File::userDesktopDirectory)
+                    .getNonexistentChildFile("SimpleEQ1-profile", ".json");
+    profiler.writeReport(file);
+}
+
+void ProfilerOverlay::paint(juce::Graphics& g) {
+    g.fillAll(juce::Colours::black.withAlpha(0.6f));
+    g.setColour(juce::Colours::white);
+    g.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 11.f, juce::Font::plain));
+
+    juce::StringArray lines;
+    lines.add(juce::String::formatted("budget %5.1f%% mean %5.1f%% p99 %5.1f%% max",
+                                      statistics.meanBudgetPercent, statistics.p99BudgetPercent,
+                                      statistics.maxBudgetPercent));
+
+    for (int stage = 0; stage < ProcessingProfiler::NumStages; ++stage) {
+        auto& timing = statistics.stages[(size_t) stage];
+
+        if (timing.maxMicroseconds > 0.0)
+            lines.add(juce::String(ProcessingProfiler::getStageName(stage)).paddedRight(' ', 18)
+                      + juce::String::formatted("%8.1f %8.1f %8.1f us", timing.meanMicroseconds,
+                                                timing.p99Microseconds, timing.maxMicroseconds));
+    }
+
+    lines.add(juce::String("design thread").paddedRight(' ', 18)
+              + juce::String::formatted("%8.1f %8.1f %8.1f us", statistics.designThread.meanMicroseconds,
+                                        statistics.designThread.p99Microseconds,
+                                        statistics.designThread.maxMicroseconds));
+    lines.add("xrun risk " + juce::String(statistics.xrunRiskBlocks) + "/" + juce::String(statistics.totalBlocks)
+              + "  updates " + juce::String(statistics.coefficientUpdates)
+              + "  designs " + juce::String(statistics.designs));
+
+    g.drawMultiLineText(lines.joinIntoString("\n"), 4, 12, getWidth() - 8);
+}
+
+#endif
@@ -0,0 +1,191 @@
+/*
+  ==============================================================================
+
+    ProcessingProfiler.h
+
+    Optional timing instrumentation for the processing chain. Compiled in
+    with SIMPLEEQ_ENABLE_PROFILING=1; otherwise the SIMPLEEQ_PROFILE_* macros
+    expand to nothing and the profiler doesn't exist, so there's no cost at all.
+
+    The audio thread timestamps each stage of a block and pushes one record
+    per block into a lock-free single-producer/single-consumer ring; the
+    design thread does the same for every redesign. A reader on another
+    thread (the editor's overlay, or a dump to a file) pulls the records and
+    turns them into statistics.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef SIMPLEEQ_ENABLE_PROFILING
+ #define SIMPLEEQ_ENABLE_PROFILING 0
+#endif
+
+#if SIMPLEEQ_ENABLE_PROFILING
+
+class ProcessingProfiler {
+public:
+    enum Stage {
+        Block,                  //the whole processBlock
+        Design,                 //inline design while rendering offline
+        ApplyCoefficients,      //picking up the design thread's coefficients
+        Ramps,                  //redesigns while parameters are smoothed
+        Filters,                //the fused IIR cascade
+        Oversampling,           //up + down sampling
+        LinearPhase,            //the FIR convolution
+        Analyzer,               //the spectrum analyzer taps
+        NumStages
+    };
+
+    static const char* getStageName(int stage) noexcept;
+
+    //(31) a block is at risk of an xrun when it uses more than this much of its time budget
+    static constexpr double xrunRiskBudgetFraction = 0.7;
+
+    //(31) the statistics cover the most recent blocks / designs
+    static constexpr int historySize = 4096;
+
+    //(31) timestamps come from the high resolution counter (the TSC or its OS
+    //equivalent), which is cheap enough to read several times per block
+    static juce::int64 now() noexcept { return juce::Time::getHighResolutionTicks(); }
+
+    //(31) audio thread
+    void beginBlock(int numSamples, double sampleRate) noexcept;
+    void endBlock() noexcept;
+    void addStageTime(Stage stage, juce::int64 ticks) noexcept { current.ticks[(size_t) stage] += ticks; }
+    void countCoefficientUpdate() noexcept { ++current.coefficientUpdates; }
+
+    //(31) design thread
+    void addDesignTime(juce::int64 ticks) noexcept;
+
+    struct StageStatistics {
+        double meanMicroseconds = 0.0, p99Microseconds = 0.0, maxMicroseconds = 0.0;
+    };
+
+    struct Statistics {
+        std::array<StageStatistics, NumStages> stages;
+        StageStatistics designThread;
+
+        int numBlocks = 0;                          //in the history
+        double meanBudgetPercent = 0.0, p99BudgetPercent = 0.0, maxBudgetPercent = 0.0;
+
+        juce::int64 totalBlocks = 0;                //since the start
+        juce::int64 xrunRiskBlocks = 0;
+        juce::int64 droppedRecords = 0;             //the reader fell behind
+        juce::int64 coefficientUpdates = 0;         //applied on the audio thread
+        juce::int64 designs = 0;                    //run on the design thread
+    };
+
+    //(31) reader side, one thread at a time (message thread)
+    Statistics getStatistics();
+    static juce::var toJson(const Statistics& statistics);
+    bool writeReport(const juce::File& file);
+
+    //(31) RAII helpers behind the macros below
+    struct BlockScope {
+        BlockScope(ProcessingProfiler& p, int numSamples, double sampleRate) noexcept : profiler(p) {
+            profiler.beginBlock(numSamples, sampleRate);
+        }
+        ~BlockScope() { profiler.endBlock(); }
+
+        ProcessingProfiler& profiler;
+    };
+
+    struct StageScope {
+        StageScope(ProcessingProfiler& p, Stage s) noexcept : profiler(p), stage(s), start(now()) {}
+        ~StageScope() { profiler.addStageTime(stage, now() - start); }
+
+        ProcessingProfiler& profiler;
+        Stage stage;
+        juce::int64 start;
+    };
+
+    struct DesignScope {
+        explicit DesignScope(ProcessingProfiler& p) noexcept : profiler(p), start(now()) {}
+        ~DesignScope() { profiler.addDesignTime(now() - start); }
+
+        ProcessingProfiler& profiler;
+        juce::int64 start;
+    };
+
+private:
+    struct BlockRecord {
+        std::array<juce::int64, NumStages> ticks{};
+        juce::int64 startTicks = 0;
+        int numSamples = 0;
+        double sampleRate = 0.0;
+        juce::uint32 coefficientUpdates = 0;
+    };
+
+    static constexpr int ringSize = 1024;
+
+    template <typename Record>
+    struct Ring {
+        bool push(const Record& record) noexcept {
+            const auto scope = fifo.write(1);
+
+            if (scope.blockSize1 == 0)
+                return false;
+
+            records[(size_t) scope.startIndex1] = record;
+            return true;
+        }
+
+        template <typename Callback>
+        void pull(Callback&& callback) {
+            const auto scope = fifo.read(fifo.getNumReady());
+            scope.forEach([&](int index) { callback(records[(size_t) index]); });
+        }
+
+        juce::AbstractFifo fifo{ ringSize };
+        std::array<Record, ringSize> records{};
+    };
+
+    BlockRecord current;                                        //audio thread only
+    Ring<BlockRecord> blocks;
+    Ring<juce::int64> designs;
+    std::atomic<juce::int64> droppedRecords{ 0 };
+
+    //reader side
+    std::vector<BlockRecord> blockHistory;
+    std::vector<juce::int64> designHistory;
+    int nextBlock = 0, nextDesign = 0;
+    juce::int64 totalBlocks = 0, xrunRiskBlocks = 0, coefficientUpdates = 0, totalDesigns = 0;
+};
+
+//(31) debug overlay for the editor: the statistics as text, a few times a
+//second; clicking it dumps the full report to a JSON file on the desktop
+class ProfilerOverlay : public juce::Component,
+                        private juce::Timer {
+public:
+    explicit ProfilerOverlay(ProcessingProfiler& profilerToUse);
+
+    void paint(juce::Graphics& g) override;
+    void mouseUp(const juce::MouseEvent& event) override;
+
+private:
+    void timerCallback() override;
+
+    ProcessingProfiler& profiler;
+    ProcessingProfiler::Statistics statistics;
+};
+
+ #define SIMPLEEQ_PROFILE_BLOCK(profiler, numSamples, sampleRate) \
+    ProcessingProfiler::BlockScope JUCE_JOIN_MACRO(profileBlock, __LINE__)(profiler, numSamples, sampleRate)
+ #define SIMPLEEQ_PROFILE_STAGE(profiler, stage) \
+    ProcessingProfiler::StageScope JUCE_JOIN_MACRO(profileStage, __LINE__)(profiler, ProcessingProfiler::stage)
+ #define SIMPLEEQ_PROFILE_DESIGN(profiler) \
+    ProcessingProfiler::DesignScope JUCE_JOIN_MACRO(profileDesign, __LINE__)(profiler)
+ #define SIMPLEEQ_PROFILE_COEFFICIENT_UPDATE(profiler) profiler.countCoefficientUpdate()
+
+#else
+
+ #define SIMPLEEQ_PROFILE_BLOCK(profiler, numSamples, sampleRate)
+ #define SIMPLEEQ_PROFILE_STAGE(profiler, stage)
+ #define SIMPLEEQ_PROFILE_DESIGN(profiler)
+ #define SIMPLEEQ_PROFILE_COEFFICIENT_UPDATE(profiler)
+
+#endif
@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    ResponseCurve.cpp
+
+  ==============================================================================
+*/
+
+#include "ResponseCurve.h"
+#include "PluginProcessor.h"
+
+//==============================================================================
+ResponseCurve::ResponseCurve()
+    : frequencies((size_t) numPoints), cosOmega((size_t) numPoints), cosTwoOmega((size_t) numPoints),
+      numerator((size_t) numPoints), denominator((size_t) numPoints), section((size_t) numPoints),
+      decibels((size_t) numPoints, 0.f) {
+    for (int i = 0; i < numPoints; ++i)
+        frequencies[(size_t) i] = juce::mapToLog10((double) i / (numPoints - 1), minFrequency, maxFrequency);
+}
+
+bool ResponseCurve::update(const CoefficientSet& coefficients) {
+    if (coefficients.sampleRate <= 0.0)
+        return false;
+
+    if (hasCurve && coefficients.generations == evaluatedGenerations && coefficients.sampleRate == gridSampleRate)
+        return false;
+
+    evaluate(coefficients);
+
+    evaluatedGenerations = coefficients.generations;
+    hasCurve = true;
+    pathDirty = true;
+    return true;
+}
+
+void ResponseCurve::evaluate(const CoefficientSet& coefficients) {
+    using FVO = juce::FloatVectorOperations;
+
+    if (coefficients.sampleRate != gridSampleRate) {
+        gridSampleRate = coefficients.sampleRate;
+
+        for (size_t i = 0; i < (size_t) numPoints; ++i) {
+            auto omega = juce::MathConstants<double>::twoPi * frequencies[i] / gridSampleRate;
+            cosOmega[i] = std::cos(omega);
+            cosTwoOmega[i] = std::cos(2.0 * omega);
+        }
+    }
+
+    FVO::fill(numerator.data(), 1.0, numPoints);
+    FVO::fill(denominator.data(), 1.0, numPoints);
+
+    //(24) |b0 + b1 z^-1 + b2 z^-2|^2 on the unit circle is
+    //b0^2 + b1^2 + b2^2 + 2 (b0 b1 + b1 b2) cos(w) + 2 b0 b2 cos(2w), and the
+    //same goes for the denominator with (1, a1, a2)
+    auto accumulate = [this](std::vector<double>& product, double x0, double x1, double x2) {
+        FVO::fill(section.data(), x0 * x0 + x1 * x1 + x2 * x2, numPoints);
+        FVO::addWithMultiply(section.data(), cosOmega.data(), 2.0 * (x0 * x1 + x1 * x2), numPoints);
+        FVO::addWithMultiply(section.data(), cosTwoOmega.data(), 2.0 * x0 * x2, numPoints);
+        FVO::multiply(product.data(), section.data(), numPoints);
+    };
+
+    coefficients.forEachActiveSection([&](const BiquadCoefficients& c) {
+        accumulate(numerator, c.b0, c.b1, c.b2);
+        accumulate(denominator, 1.0, c.a1, c.a2);
+    });
+
+    //10 log10 of the squared magnitude, clamped so a deep notch stays drawable
+    for (size_t i = 0; i < (size_t) numPoints; ++i) {
+        auto power = numerator[i] / juce::jmax(denominator[i], 1.0e-30);
+        decibels[i] = (float) juce::jlimit(minDecibels, maxDecibels, 10.0 * std::log10(juce::jmax(power, 1.0e-12)));
+    }
+}
+
+const juce::Path& ResponseCurve::getPath(juce::Rectangle<float> bounds) {
+    if (!pathDirty && bounds == pathBounds)
+        return path;
+
+    path.clear();
+    pathBounds = bounds;
+    pathDirty = false;
+
+    if (!hasCurve || bounds.isEmpty())
+        return path;
+
+    path.preallocateSpace(numPoints * 3);
+
+    for (int i = 0; i < numPoints; ++i) {
+        auto x = bounds.getX() + bounds.getWidth() * (float) i / (float) (numPoints - 1);
+        auto y = juce::jmap(decibels[(size_t) i], (float) minDecibels, (float) maxDecibels,
+                            bounds.getBottom(), bounds.getY());
+
+        if (i == 0)
+            path.startNewSubPath(x, y);
+        else
+            path.lineTo(x, y);
+    }
+
+    return path;
+}
+
+//==============================================================================
+ResponseCurveDisplay::ResponseCurveDisplay(SimpleEQ1AudioProcessor& processorToUse) : processor(processorToUse) {
+    setInterceptsMouseClicks(false, false);
+    startTimerHz(30);
+}
+
+void ResponseCurveDisplay::timerCallback() {
+    if (!processor.getCoefficientsForDisplay(coefficients))
+        return;
+
+    auto changed = curve.update(coefficients.sets[0]);
+    auto showSecond = !coefficients.setsMatch;
+
+    if (showSecond)
+        changed = secondCurve.update(coefficients.sets[1]) || changed;
+
+    if (changed || showSecond != showSecondCurve) {
+        showSecondCurve = showSecond;
+        repaint();
+    }
+}
+
+void ResponseCurveDisplay::resized() {
+    timerCallback();
+}
+
+void ResponseCurveDisplay::paint(juce::Graphics& g) {
+    auto bounds = getLocalBounds().toFloat().reduced(0.f, 1.f);
+
+    //0 dB line
+    g.setColour(juce::Colours::white.withAlpha(0.3f));
+    g.drawHorizontalLine(juce::roundToInt(bounds.getCentreY()), bounds.getX(), bounds.getRight());
+
+    if (showSecondCurve) {
+        g.setColour(juce::Colours::orange);
+        g.strokePath(secondCurve.getPath(bounds), juce::PathStrokeType(2.f));
+    }
+
+    g.setColour(juce::Colours::white);
+    g.strokePath(curve.getPath(bounds), juce::PathStrokeType(2.f));
+}
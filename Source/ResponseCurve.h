@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    ResponseCurve.h
+
+    The magnitude response of the current filter settings, for the editor.
+    The curve is only re-evaluated when one of the stages has actually been
+    redesigned, all the frequencies are evaluated in one vectorised pass per
+    section, and the resulting path is cached until either the curve or the
+    component size changes.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientHandoff.h"
+
+class SimpleEQ1AudioProcessor;
+
+//(24) batch evaluation of a CoefficientSet over a fixed, log-spaced frequency grid
+class ResponseCurve {
+public:
+    static constexpr int numPoints = 512;
+    static constexpr double minFrequency = 20.0, maxFrequency = 20000.0;
+    static constexpr double minDecibels = -30.0, maxDecibels = 30.0;
+
+    ResponseCurve();
+
+    //(24) re-evaluates the curve if any stage generation or the rate changed;
+    //returns true if it did
+    bool update(const CoefficientSet& coefficients);
+
+    //(24) the cached path, rebuilt only if the curve or the bounds changed
+    const juce::Path& getPath(juce::Rectangle<float> bounds);
+
+private:
+    void evaluate(const CoefficientSet& coefficients);
+
+    //|H|^2 of a biquad is a ratio of two polynomials in cos(w) and cos(2w),
+    //so the trigonometry only depends on the grid and the rate
+    std::vector<double> frequencies, cosOmega, cosTwoOmega;
+    std::vector<double> numerator, denominator, section;
+    std::vector<float> decibels;
+
+    double gridSampleRate = 0.0;
+    decltype(CoefficientSet::generations) evaluatedGenerations{};
+    bool hasCurve = false;
+
+    juce::Path path;
+    juce::Rectangle<float> pathBounds;
+    bool pathDirty = true;
+};
+
+//(24) draws the response curve over the analyzer; polls the processor for new
+//coefficients at a capped rate and only repaints when the curve changed
+class ResponseCurveDisplay : public juce::Component,
+                             private juce::Timer {
+public:
+    explicit ResponseCurveDisplay(SimpleEQ1AudioProcessor& processorToUse);
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+private:
+    void timerCallback() override;
+
+    SimpleEQ1AudioProcessor& processor;
+    ChannelCoefficients coefficients;
+    ResponseCurve curve;
+
+    //(27) the side (or right) channel's curve, shown while it differs from the first
+    ResponseCurve secondCurve;
+    bool showSecondCurve = false;
+};
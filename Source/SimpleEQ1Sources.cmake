@@ -0,0 +1,22 @@
+# The plug-in's translation units, for the CMake targets that build the
+# processor outside of the Projucer project (Benchmarks, BatchRender).
+#
+#   include(${CMAKE_CURRENT_SOURCE_DIR}/../Source/SimpleEQ1Sources.cmake)
+#   target_sources(MyTarget PRIVATE main.cpp ${SIMPLEEQ1_SOURCES})
+#   target_include_directories(MyTarget PRIVATE ${SIMPLEEQ1_SOURCE_DIR})
+#
+# Adding a .cpp to Source/ means adding it here and to SimpleEQ1.jucer; the
+# Projucer keeps its own file list and can't read this one.
+
+set(SIMPLEEQ1_SOURCE_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+set(SIMPLEEQ1_SOURCES
+    ${SIMPLEEQ1_SOURCE_DIR}/PluginProcessor.cpp
+    ${SIMPLEEQ1_SOURCE_DIR}/PluginEditor.cpp
+    ${SIMPLEEQ1_SOURCE_DIR}/LinearPhaseEngine.cpp
+    ${SIMPLEEQ1_SOURCE_DIR}/SpectrumAnalyzer.cpp
+    ${SIMPLEEQ1_SOURCE_DIR}/ResponseCurve.cpp
+    ${SIMPLEEQ1_SOURCE_DIR}/DynamicPeak.cpp
+    ${SIMPLEEQ1_SOURCE_DIR}/AutoGain.cpp
+    ${SIMPLEEQ1_SOURCE_DIR}/ButterworthCache.cpp
+    ${SIMPLEEQ1_SOURCE_DIR}/ProcessingProfiler.cpp)
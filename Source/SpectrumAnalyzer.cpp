@@ -0,0 +1,243 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyzer.h"
+
+//==============================================================================
+void AnalyzerFifo::push(const juce::dsp::AudioBlock<float>& block) noexcept {
+    //(23) nobody is looking: this is all the audio thread pays
+    if (!active.load(std::memory_order_relaxed) || block.getNumChannels() == 0)
+        return;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite((int) block.getNumSamples(), start1, size1, start2, size2);
+
+    write(block, 0, start1, size1);
+    write(block, size1, start2, size2);
+
+    fifo.finishedWrite(size1 + size2);
+}
+
+void AnalyzerFifo::write(const juce::dsp::AudioBlock<float>& block, int sourceStart,
+                         int destinationStart, int numSamples) noexcept {
+    if (numSamples <= 0)
+        return;
+
+    auto* destination = buffer.data() + destinationStart;
+    const auto numChannels = block.getNumChannels();
+    const auto gain = 1.f / (float) numChannels;
+
+    juce::FloatVectorOperations::copyWithMultiply(destination, block.getChannelPointer(0) + sourceStart, gain, numSamples);
+
+    for (size_t channel = 1; channel < numChannels; ++channel)
+        juce::FloatVectorOperations::addWithMultiply(destination, block.getChannelPointer(channel) + sourceStart, gain, numSamples);
+}
+
+int AnalyzerFifo::pull(float* destination, int maxNumSamples) noexcept {
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(maxNumSamples, start1, size1, start2, size2);
+
+    if (size1 > 0)
+        std::copy_n(buffer.data() + start1, size1, destination);
+
+    if (size2 > 0)
+        std::copy_n(buffer.data() + start2, size2, destination + size1);
+
+    fifo.finishedRead(size1 + size2);
+    return size1 + size2;
+}
+
+//==============================================================================
+SpectrumAnalyzer::SpectrumAnalyzer(AnalyzerFifo& preEqSource, AnalyzerFifo& postEqSource,
+                                   const juce::AudioProcessor& processorToUse)
+    : juce::Thread("SimpleEQ spectrum analyzer"),
+      processor(processorToUse),
+      preEq(preEqSource),
+      postEq(postEqSource) {
+    preEq.levels.fill(minDecibels);
+    postEq.levels.fill(minDecibels);
+    latestPreEq = preEq.levels;
+    latestPostEq = postEq.levels;
+
+    preEq.source.setActive(true);
+    postEq.source.setActive(true);
+    startThread();
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer() {
+    preEq.source.setActive(false);
+    postEq.source.setActive(false);
+    stopThread(1000);
+}
+
+bool SpectrumAnalyzer::getLatestSpectra(Spectrum& preEqDestination, Spectrum& postEqDestination, juce::uint32& lastFrame) {
+    const juce::SpinLock::ScopedLockType lock(spectraLock);
+
+    if (frameCounter == lastFrame)
+        return false;
+
+    preEqDestination = latestPreEq;
+    postEqDestination = latestPostEq;
+    lastFrame = frameCounter;
+    return true;
+}
+
+float SpectrumAnalyzer::getFrequencyForDisplayPoint(int point) noexcept {
+    auto proportion = (float) point / (float) (numDisplayPoints - 1);
+    return juce::mapToLog10(proportion, minFrequency, maxFrequency);
+}
+
+//(23) one FFT per source per frame, no matter how much audio arrived: the
+//analyzer's CPU use is capped by framesPerSecond, not by the host block rate
+void SpectrumAnalyzer::run() {
+    while (!threadShouldExit()) {
+        const auto sampleRate = processor.getSampleRate();
+
+        if (sampleRate > 0.0) {
+            if (sampleRate != binRangesSampleRate)
+                updateBinRanges(sampleRate);
+
+            const auto preEqChanged = analyse(preEq);
+            const auto postEqChanged = analyse(postEq);
+
+            //(23) a stopped transport leaves the spectra as they are, so the
+            //display has nothing to repaint
+            if (preEqChanged || postEqChanged) {
+                const juce::SpinLock::ScopedLockType lock(spectraLock);
+                latestPreEq = preEq.levels;
+                latestPostEq = postEq.levels;
+                ++frameCounter;
+            }
+        }
+
+        wait(1000 / framesPerSecond);
+    }
+}
+
+//(23) each display point covers the FFT bins between it and the next one, so
+//the log-frequency binning is just a max over a precomputed range
+void SpectrumAnalyzer::updateBinRanges(double sampleRate) {
+    const auto lastBin = fftSize / 2;
+
+    for (int point = 0; point <= numDisplayPoints; ++point) {
+        auto frequency = getFrequencyForDisplayPoint(juce::jmin(point, numDisplayPoints - 1))
+                       * (point == numDisplayPoints ? 1.01f : 1.f);
+        binRanges[(size_t) point] = juce::jlimit(0, lastBin, juce::roundToInt(frequency * fftSize / sampleRate));
+    }
+
+    binRangesSampleRate = sampleRate;
+}
+
+bool SpectrumAnalyzer::analyse(Analysis& analysis) {
+    //keep the most recent fftSize samples
+    const auto numNew = analysis.source.pull(analysis.scratch.data(), (int) analysis.scratch.size());
+
+    if (numNew <= 0)
+        return false;
+
+    if (numNew >= fftSize) {
+        std::copy_n(analysis.scratch.data() + (numNew - fftSize), fftSize, analysis.history.data());
+    }
+    else {
+        std::move(analysis.history.begin() + numNew, analysis.history.end(), analysis.history.begin());
+        std::copy_n(analysis.scratch.data(), numNew, analysis.history.data() + (fftSize - numNew));
+    }
+
+    std::fill(analysis.fftData.begin(), analysis.fftData.end(), 0.f);
+    std::copy(analysis.history.begin(), analysis.history.end(), analysis.fftData.begin());
+
+    window.multiplyWithWindowingTable(analysis.fftData.data(), (size_t) fftSize);
+    fft.performFrequencyOnlyForwardTransform(analysis.fftData.data());
+
+    //a full-scale sine reads 0 dB (the hann window halves the amplitude)
+    const auto normalisation = 4.f / (float) fftSize;
+    const auto decayPerFrame = 60.f / (float) framesPerSecond; //60 dB/s fall-off
+
+    for (int point = 0; point < numDisplayPoints; ++point) {
+        auto firstBin = binRanges[(size_t) point];
+        auto lastBin = juce::jmax(firstBin, binRanges[(size_t) point + 1] - 1);
+
+        auto magnitude = 0.f;
+
+        for (int bin = firstBin; bin <= lastBin; ++bin)
+            magnitude = juce::jmax(magnitude, analysis.fftData[(size_t) bin]);
+
+        auto level = juce::jlimit(minDecibels, maxDecibels,
+                                  juce::Decibels::gainToDecibels(magnitude * normalisation, minDecibels));
+        auto& smoothed = analysis.levels[(size_t) point];
+        smoothed = juce::jmax(level, smoothed - decayPerFrame);
+    }
+
+    return true;
+}
+
+//==============================================================================
+SpectrumDisplay::SpectrumDisplay(SpectrumAnalyzer& analyzerToUse) : analyzer(analyzerToUse) {
+    preEq.fill(SpectrumAnalyzer::minDecibels);
+    postEq.fill(SpectrumAnalyzer::minDecibels);
+    setOpaque(true);
+    startTimerHz(SpectrumAnalyzer::framesPerSecond);
+}
+
+void SpectrumDisplay::timerCallback() {
+    if (analyzer.getLatestSpectra(preEq, postEq, lastFrame)) {
+        rebuildPaths();
+        repaint();
+    }
+}
+
+void SpectrumDisplay::resized() {
+    rebuildPaths();
+}
+
+void SpectrumDisplay::rebuildPaths() {
+    preEqPath = createPath(preEq);
+    postEqPath = createPath(postEq);
+}
+
+juce::Path SpectrumDisplay::createPath(const SpectrumAnalyzer::Spectrum& spectrum) const {
+    juce::Path path;
+    auto bounds = getLocalBounds().toFloat();
+
+    if (bounds.isEmpty())
+        return path;
+
+    for (int point = 0; point < SpectrumAnalyzer::numDisplayPoints; ++point) {
+        auto x = bounds.getX() + bounds.getWidth() * (float) point / (float) (SpectrumAnalyzer::numDisplayPoints - 1);
+        auto y = juce::jmap(spectrum[(size_t) point], SpectrumAnalyzer::minDecibels, SpectrumAnalyzer::maxDecibels,
+                            bounds.getBottom(), bounds.getY());
+
+        if (point == 0)
+            path.startNewSubPath(x, y);
+        else
+            path.lineTo(x, y);
+    }
+
+    return path;
+}
+
+void SpectrumDisplay::paint(juce::Graphics& g) {
+    g.fillAll(juce::Colours::black);
+
+    auto bounds = getLocalBounds().toFloat();
+
+    //frequency grid
+    g.setColour(juce::Colours::white.withAlpha(0.15f));
+
+    for (auto frequency : { 100.f, 1000.f, 10000.f }) {
+        auto x = bounds.getX() + bounds.getWidth()
+               * juce::mapFromLog10(frequency, SpectrumAnalyzer::minFrequency, SpectrumAnalyzer::maxFrequency);
+        g.drawVerticalLine(juce::roundToInt(x), bounds.getY(), bounds.getBottom());
+    }
+
+    g.setColour(juce::Colours::lightblue.withAlpha(0.5f));
+    g.strokePath(preEqPath, juce::PathStrokeType(1.f));
+
+    g.setColour(juce::Colours::orange);
+    g.strokePath(postEqPath, juce::PathStrokeType(1.5f));
+}
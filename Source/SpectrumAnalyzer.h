@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.h
+
+    Pre/post EQ spectrum analysis. The audio thread only copies samples into
+    a lock-free single-producer/single-consumer FIFO (and only while an
+    editor is showing the analyzer); the windowed FFTs, the log-frequency
+    binning and the path building all happen elsewhere, at a capped rate.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//(23) audio thread -> analyzer thread FIFO of mono-summed samples.
+//push() never blocks or allocates: if the reader falls behind, the samples
+//that don't fit are simply dropped.
+class AnalyzerFifo {
+public:
+    static constexpr int capacity = 1 << 15;
+
+    AnalyzerFifo() : buffer((size_t) capacity, 0.f) {}
+
+    void setActive(bool shouldBeActive) noexcept { active.store(shouldBeActive); }
+
+    //(23) audio thread
+    void push(const juce::dsp::AudioBlock<float>& block) noexcept;
+
+    //(23) analyzer thread: returns the number of samples read
+    int pull(float* destination, int maxNumSamples) noexcept;
+
+private:
+    void write(const juce::dsp::AudioBlock<float>& block, int sourceStart, int destinationStart, int numSamples) noexcept;
+
+    juce::AbstractFifo fifo{ capacity };
+    std::vector<float> buffer;
+    std::atomic<bool> active{ false };
+};
+
+//(23) background thread that turns the FIFO contents into smoothed,
+//log-frequency spectra for the pre and post EQ signals
+class SpectrumAnalyzer : private juce::Thread {
+public:
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int numDisplayPoints = 256;
+    static constexpr int framesPerSecond = 30;
+
+    static constexpr float minFrequency = 20.f, maxFrequency = 20000.f;
+    static constexpr float minDecibels = -90.f, maxDecibels = 6.f;
+
+    using Spectrum = std::array<float, numDisplayPoints>;
+
+    SpectrumAnalyzer(AnalyzerFifo& preEqSource, AnalyzerFifo& postEqSource, const juce::AudioProcessor& processor);
+    ~SpectrumAnalyzer() override;
+
+    //(23) copies the latest spectra (in dB) if there's a frame newer than lastFrame
+    bool getLatestSpectra(Spectrum& preEq, Spectrum& postEq, juce::uint32& lastFrame);
+
+    static float getFrequencyForDisplayPoint(int point) noexcept;
+
+private:
+    struct Analysis {
+        explicit Analysis(AnalyzerFifo& sourceToUse) : source(sourceToUse) {}
+
+        AnalyzerFifo& source;
+        std::vector<float> history = std::vector<float>((size_t) fftSize, 0.f);
+        std::vector<float> fftData = std::vector<float>((size_t) fftSize * 2, 0.f);
+        std::vector<float> scratch = std::vector<float>((size_t) AnalyzerFifo::capacity, 0.f);
+        Spectrum levels;
+    };
+
+    void run() override;
+    void updateBinRanges(double sampleRate);
+    //(23) false when no new samples arrived, in which case the levels are left alone
+    bool analyse(Analysis& analysis);
+
+    const juce::AudioProcessor& processor;
+    Analysis preEq, postEq;
+
+    juce::dsp::FFT fft{ fftOrder };
+    juce::dsp::WindowingFunction<float> window{ (size_t) fftSize, juce::dsp::WindowingFunction<float>::hann };
+
+    double binRangesSampleRate = 0.0;
+    std::array<int, numDisplayPoints + 1> binRanges{};
+
+    juce::SpinLock spectraLock;
+    Spectrum latestPreEq, latestPostEq;
+    juce::uint32 frameCounter = 0;
+};
+
+//(23) draws the analyzer output; the paths are only rebuilt when a new
+//frame arrives, and the repaint rate is capped by the timer
+class SpectrumDisplay : public juce::Component,
+                        private juce::Timer {
+public:
+    explicit SpectrumDisplay(SpectrumAnalyzer& analyzerToUse);
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+private:
+    void timerCallback() override;
+    void rebuildPaths();
+    juce::Path createPath(const SpectrumAnalyzer::Spectrum& spectrum) const;
+
+    SpectrumAnalyzer& analyzer;
+    SpectrumAnalyzer::Spectrum preEq, postEq;
+    juce::uint32 lastFrame = 0;
+
+    juce::Path preEqPath, postEqPath;
+};